@@ -0,0 +1,165 @@
+#pragma once
+
+#include "bitboard.h"
+#include <cstdint>
+
+/**
+ * Precomputed attack tables. Leaper attacks and square geometry are built at
+ * compile time into the constant ATTACK_GEOMETRY table; slider tables are
+ * filled once at startup into static storage. Rook and bishop attacks are
+ * looked up with magic bitboards: the relevant blockers are multiplied by a
+ * magic number and the high bits index a table holding the attack set for
+ * that blocker configuration.
+ *
+ * On CPUs with fast BMI2 the blockers are instead compressed with PEXT,
+ * which needs no magic numbers. The backend is picked from CPUID at startup
+ * by pointing the rook and bishop lookups at that backend's functions, so a
+ * single binary runs everywhere and no lookup tests which backend is active.
+ */
+
+enum SliderBackend { MAGIC_SLIDERS = 0, PEXT_SLIDERS = 1 };
+
+/** The backend the lookups currently point at. */
+extern SliderBackend sliderBackend;
+
+bool cpuHasFastPext();
+
+/**
+ * Rebuilds the slider tables for the given backend and points the lookups
+ * at it.
+ * @return false (keeping the current tables) if the CPU cannot run it.
+ */
+bool initSliderAttacks(SliderBackend backend);
+
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard *attacks;
+    int shift;
+
+    unsigned index(Bitboard occupancy) const {
+        return static_cast<unsigned>(((occupancy & mask) * magic) >> shift);
+    }
+};
+
+using SliderLookup = Bitboard (*)(int square, Bitboard occupancy);
+
+extern SliderLookup rookLookup;
+extern SliderLookup bishopLookup;
+
+extern Magic rookMagics[64];
+extern Magic bishopMagics[64];
+/**
+ * Knight, king and pawn attacks plus the relation between every pair of
+ * squares, generated at compile time so each lookup is a single load.
+ */
+struct AttackGeometry {
+    Bitboard knight[64] = {};
+    Bitboard king[64] = {};
+    /** Squares attacked by a pawn of the given color (indexed by colorIndex). */
+    Bitboard pawn[2][64] = {};
+    /** Squares strictly between two aligned squares, empty if not aligned. */
+    Bitboard between[64][64] = {};
+    /** Whole rank, file or diagonal through two aligned squares. */
+    Bitboard line[64][64] = {};
+    /** Number of king steps from one square to the other. */
+    uint8_t distance[64][64] = {};
+
+    constexpr AttackGeometry() {
+        constexpr int knightDeltas[8][2] = {{2, 1},   {2, -1},  {1, 2},
+                                            {1, -2},  {-1, 2},  {-1, -2},
+                                            {-2, 1},  {-2, -1}};
+        // The first four are the rook directions, the last four the bishop's
+        constexpr int kingDeltas[8][2] = {{1, 0},  {-1, 0}, {0, 1},  {0, -1},
+                                          {1, 1},  {1, -1}, {-1, 1}, {-1, -1}};
+
+        for (int square = 0; square < 64; ++square) {
+            int row = square >> 3, col = square & 7;
+            for (int i = 0; i < 8; ++i) {
+                knight[square] |=
+                    target(row + knightDeltas[i][0], col + knightDeltas[i][1]);
+                king[square] |=
+                    target(row + kingDeltas[i][0], col + kingDeltas[i][1]);
+            }
+            // White pawns move towards row 0, black pawns towards row 7
+            pawn[0][square] = target(row - 1, col - 1) | target(row - 1, col + 1);
+            pawn[1][square] = target(row + 1, col - 1) | target(row + 1, col + 1);
+
+            for (int other = 0; other < 64; ++other) {
+                int rows = (other >> 3) - row, cols = (other & 7) - col;
+                rows = rows < 0 ? -rows : rows;
+                cols = cols < 0 ? -cols : cols;
+                distance[square][other] = uint8_t(rows > cols ? rows : cols);
+            }
+
+            for (int d = 0; d < 8; ++d) {
+                int dr = kingDeltas[d][0], dc = kingDeltas[d][1];
+                Bitboard fullLine = ray(row, col, dr, dc) |
+                                    ray(row, col, -dr, -dc) |
+                                    squareBitboard(square);
+                Bitboard passed = EMPTY_BITBOARD;
+                for (int r = row + dr, c = col + dc; onBoard(r, c);
+                     r += dr, c += dc) {
+                    between[square][r * 8 + c] = passed;
+                    line[square][r * 8 + c] = fullLine;
+                    passed |= squareBitboard(r * 8 + c);
+                }
+            }
+        }
+    }
+
+  private:
+    static constexpr bool onBoard(int row, int col) {
+        return row >= 0 && row < 8 && col >= 0 && col < 8;
+    }
+
+    static constexpr Bitboard target(int row, int col) {
+        return onBoard(row, col) ? squareBitboard(row * 8 + col)
+                                 : EMPTY_BITBOARD;
+    }
+
+    static constexpr Bitboard ray(int row, int col, int dr, int dc) {
+        Bitboard squares = EMPTY_BITBOARD;
+        for (int r = row + dr, c = col + dc; onBoard(r, c); r += dr, c += dc)
+            squares |= squareBitboard(r * 8 + c);
+        return squares;
+    }
+};
+
+inline constexpr AttackGeometry ATTACK_GEOMETRY;
+
+inline Bitboard rookAttacks(int square, Bitboard occupancy) {
+    return rookLookup(square, occupancy);
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupancy) {
+    return bishopLookup(square, occupancy);
+}
+
+inline Bitboard queenAttacks(int square, Bitboard occupancy) {
+    return rookAttacks(square, occupancy) | bishopAttacks(square, occupancy);
+}
+
+constexpr Bitboard knightAttacks(int square) {
+    return ATTACK_GEOMETRY.knight[square];
+}
+
+constexpr Bitboard kingAttacks(int square) {
+    return ATTACK_GEOMETRY.king[square];
+}
+
+constexpr Bitboard pawnAttacks(Color color, int square) {
+    return ATTACK_GEOMETRY.pawn[colorIndex(color)][square];
+}
+
+constexpr Bitboard betweenSquares(int from, int to) {
+    return ATTACK_GEOMETRY.between[from][to];
+}
+
+constexpr Bitboard lineThrough(int from, int to) {
+    return ATTACK_GEOMETRY.line[from][to];
+}
+
+constexpr int squareDistance(int from, int to) {
+    return ATTACK_GEOMETRY.distance[from][to];
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "types.h"
+#include <bit>
+#include <cstdint>
+
+/**
+ * Bitboard primitives.
+ * Squares are indexed as row * 8 + col, so bit 0 is a8 and bit 63 is h1,
+ * matching the row/col layout used by Square.
+ */
+
+using Bitboard = uint64_t;
+
+constexpr Bitboard EMPTY_BITBOARD = 0ULL;
+constexpr Bitboard ALL_SQUARES = ~0ULL;
+
+constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H = 0x8080808080808080ULL;
+
+constexpr Bitboard rowBitboard(int row) { return 0xFFULL << (row * 8); }
+
+/**
+ * Color-specialized pawn geometry: white pawns move towards row 0 (lower
+ * indices), black pawns towards row 7.
+ */
+template <Color Us> constexpr int PAWN_PUSH = (Us == WHITE) ? -8 : 8;
+template <Color Us> constexpr int PAWN_START_ROW = (Us == WHITE) ? 6 : 1;
+template <Color Us> constexpr int PROMOTION_ROW = (Us == WHITE) ? 0 : 7;
+
+/** Shifts every square by `delta` indices (rows * 8 + cols). */
+template <int delta> constexpr Bitboard shift(Bitboard bb) {
+    return (delta > 0) ? bb << delta : bb >> -delta;
+}
+
+inline int squareIndex(Square square) { return square.row * 8 + square.col; }
+
+inline Square indexToSquare(int index) { return Square(index >> 3, index & 7); }
+
+constexpr Bitboard squareBitboard(int index) { return 1ULL << index; }
+
+inline Bitboard squareBitboard(Square square) {
+    return squareBitboard(squareIndex(square));
+}
+
+inline int popCount(Bitboard bb) { return std::popcount(bb); }
+
+inline int lsbIndex(Bitboard bb) { return std::countr_zero(bb); }
+
+/**
+ * Removes the least significant set bit and returns its index.
+ */
+inline int popLsb(Bitboard &bb) {
+    int index = lsbIndex(bb);
+    bb &= bb - 1;
+    return index;
+}
+
+constexpr int colorIndex(Color color) { return (color == WHITE) ? 0 : 1; }
+
+/**
+ * Index of the bitboard holding the given piece: 0-5 white pawn to king,
+ * 6-11 black pawn to king (same order as the NN piece planes).
+ */
+inline int bitboardIndex(ColoredPiece cp) {
+    return ((cp.color == WHITE) ? 0 : 6) + (int)(cp.piece) - 1;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "bitboard.h"
+#include "types.h"
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Everything that defines a position, in one flat struct that is copied
+ * with a plain memcpy: one bitboard per colored piece (indexed by
+ * bitboardIndex), occupancy per color (indexed by colorIndex), a
+ * square-indexed mailbox, the Zobrist hash and the irreversible state.
+ * Position owns one and keeps its fields in sync.
+ */
+
+struct BoardState {
+    Bitboard pieceBitboards[12];
+    Bitboard colorBitboards[2];
+    uint64_t zobristHash;
+    /** color * piece per square (e.g. -6 is a black king), 0 when empty. */
+    int8_t mailbox[64];
+    /** Square index behind a pawn that just moved two, -1 if none. */
+    int8_t enPassantIndex;
+    Color turn;
+    CastlingState castleState;
+    uint16_t halfmoveClock;
+    uint16_t fullmoveNumber;
+
+    ColoredPiece pieceAt(int index) const {
+        int8_t code = mailbox[index];
+        if (code == 0)
+            return NO_COLORED_PIECE;
+        return code > 0 ? ColoredPiece(WHITE, Piece(code))
+                        : ColoredPiece(BLACK, Piece(-code));
+    }
+
+    void setMailbox(int index, ColoredPiece cp) {
+        mailbox[index] = static_cast<int8_t>(int(cp.color) * int(cp.piece));
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<BoardState>);
+static_assert(sizeof(BoardState) < 200);
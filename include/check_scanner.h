@@ -1,8 +1,11 @@
 #pragma once
 
+#include "bitboard.h"
 #include "types.h"
 class Position;
 
+enum GameStatus { IN_PROGRESS, CHECKMATE, STALEMATE };
+
 /**
  * Checking behaviour for the current board's color (given as param).
  */
@@ -13,10 +16,10 @@ class CheckScanner {
     bool isInCheck(Color color) const;
     bool isInCheckmate(Color color) const;
     bool isInStalemate(Color color) const;
+    GameStatus getGameStatus(Color color) const;
     bool isSquareInCheck(Square square, Color color) const;
+    Bitboard attackersTo(int square, Bitboard occupancy) const;
 
   private:
     Position *position;
-    bool areThereLegalMoves(Color color) const;
-    Square getKingSquare(Color color) const;
 };
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "move_maker.h"
 #include "position.h"
+#include "transposition_table.h"
 #include <chrono>
-#include <unordered_map>
+#include <cstddef>
 
 /**
  * Finds the best move for the playing side.
@@ -10,48 +12,71 @@
 
 enum Algorithm { DEPTH_BOUNDED = 0, TIME_BOUNDED = 1 };
 
-enum NodeType { EXACT, LOWERBOUND, UPPERBOUND };
-
-struct TTEntry {
-    int score;
-    int depth;
-    NodeType type;
-    Move bestMove;
-};
-
 class Engine {
   public:
     Engine(Position *position);
     Move getBestMove();
     Move getBestMoveWithTimeLimit(int timeLimitMs);
+    void setHashSize(size_t sizeMb);
+    void setMakeMode(SearchMakeMode mode);
+    void newGame();
 
   private:
     Algorithm algorithm = TIME_BOUNDED;
     Position *position;
-    std::unordered_map<uint64_t, TTEntry> transpositionTable;
+    TranspositionTable transpositionTable;
+    /** Two quiet moves per ply that last caused a beta cutoff. */
+    Move killerMoves[MAX_PLY][2];
+    /**
+     * Cutoff scores of quiet moves, weighted by depth, by color/from/to.
+     * Kept within [0, HISTORY_MAX] by the update in recordCutoff.
+     */
+    int history[2][64][64];
+    static constexpr int HISTORY_MAX = 1 << 14;
     const int INF = 1000000;
-    const int MATE_SCORE = 100000;
+    /** Below 2^15, so every score fits a transposition table entry. */
+    const int MATE_SCORE = 32000;
     const int MAX_DEPTH = 2;
     const int MAX_TIME = 5000;
+    /**
+     * Iterative deepening stops here, leaving quiescence the rest of the
+     * MAX_PLY moves the move stack holds.
+     */
+    static constexpr int MAX_SEARCH_DEPTH = 64;
     std::chrono::steady_clock::time_point startTime;
     int timeLimitMs;
     bool isTimeUp() const;
+    void clearMoveOrdering();
+    void recordCutoff(const Move &move, int depth, int ply);
 
     int evaluate(Position *position) const;
+    int evaluateMaterial(Position *position) const;
+    int staticEval(Position *position, Color color) const;
     int evaluateLeaf(Position *position, Color color, int plyFromRoot) const;
+    int evaluateLeaf(Position *position, Color color, int plyFromRoot,
+                     GameStatus status) const;
+    GameStatus getGameStatus(Position *position,
+                             const MoveList &legalMoves) const;
     int getPieceValue(const ColoredPiece &cp) const;
     Move minimax();
     int negamax(Position *position, int depth, int alpha, int beta,
-                Color color);
+                Color color, int ply);
     int quiescence(Position *position, int alpha, int beta, Color color,
                    int plyFromRoot);
-    int staticExchangeEval(Position *pos, Square sq, Color sideToMove);
-    std::vector<std::pair<Square, ColoredPiece>>
-    getSortedAttackers(Position *pos, Square target) const;
-    Color oppositeColor(Color color) {
+    int staticExchangeEval(Position *pos, Square sq, Color sideToMove) const;
+    int staticExchangeEval(Position *pos, const Move &move) const;
+    int exchange(Position *pos, int targetIndex, Color sideToMove,
+                 Bitboard from, Piece attacker) const;
+    Bitboard getLeastValuableAttacker(Position *pos, Bitboard attackers,
+                                      Color color, Piece &piece) const;
+    Color oppositeColor(Color color) const {
         return (color == WHITE) ? BLACK : WHITE;
     }
     int scoreMove(const Move &move, const Position *pos) const;
 
+    friend class MovePicker;
     friend class ChessEngineTest_EvaluatePosition_Test;
+    friend class ChessEngineTest_StaticExchangeEval_Test;
+    friend class ChessEngineTest_HistoryStaysBounded_Test;
+    friend class ChessEngineTest_MateScoreCountsPlies_Test;
 };
\ No newline at end of file
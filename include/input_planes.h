@@ -0,0 +1,28 @@
+#pragma once
+
+#include "bitboard.h"
+#include "types.h"
+#include <array>
+#include <cstddef>
+
+/**
+ * NN input planes packed one bit per square, in the tensor plane order:
+ * 0-11 the piece bitboards, 12 side to move, 13-16 castling rights and
+ * 17 the en passant file. Expanding them gives the float layout of
+ * tensorIndex(plane, row, col), with 1.0f for set bits and 0.0f elsewhere.
+ *
+ * The expansion uses AVX2 when CPUID reports it and a scalar loop
+ * otherwise, checked once on the first call.
+ */
+
+using InputPlanes = std::array<Bitboard, NUM_PLANES>;
+
+constexpr size_t INPUT_TENSOR_SIZE = NUM_PLANES * BOARD_SIZE * BOARD_SIZE;
+
+/** Writes INPUT_TENSOR_SIZE floats to out, e.g. one slot of a batch. */
+void expandPlanes(const InputPlanes &planes, float *out);
+
+/** Portable reference expansion, also the fallback without AVX2. */
+void expandPlanesScalar(const InputPlanes &planes, float *out);
+
+bool cpuHasAvx2();
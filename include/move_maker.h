@@ -1,5 +1,6 @@
 #pragma once
 
+#include "board_state.h"
 #include "types.h"
 #include <array>
 #include <cstdint>
@@ -22,7 +23,6 @@ struct MoveContext {
     bool wasEnPassantCapture;
     bool wasCastling;
     uint64_t previousHash;
-    std::array<float, 18 * 8 * 8> previousInputTensor;
 
     bool operator==(const MoveContext &other) const {
         return move == other.move && movedPiece == other.movedPiece &&
@@ -34,11 +34,35 @@ struct MoveContext {
                previousTurn == other.previousTurn &&
                wasEnPassantCapture == other.wasEnPassantCapture &&
                wasCastling == other.wasCastling &&
-               previousHash == other.previousHash &&
-               previousInputTensor == other.previousInputTensor;
+               previousHash == other.previousHash;
     }
 };
 
+/**
+ * What doMove cannot recompute when the move is taken back: the captured
+ * piece and the irreversible state before the move.
+ */
+struct UndoInfo {
+    Move move;
+    /** Before any promotion, so only a pawn that promoted is demoted. */
+    Piece movedPiece;
+    ColoredPiece capturedPiece;
+    CastlingState castleState;
+    int8_t enPassantIndex;
+    uint16_t halfmoveClock;
+    uint64_t zobristHash;
+};
+
+/** Deepest search line (main search plus quiescence) doMove can hold. */
+constexpr int MAX_PLY = 256;
+
+/**
+ * How doMove/undoMove take a move back. MAKE_UNMAKE stores the
+ * irreversible state and reverses the move; COPY_MAKE saves the whole
+ * BoardState per ply and restores it with one copy.
+ */
+enum SearchMakeMode { MAKE_UNMAKE = 0, COPY_MAKE = 1 };
+
 class MoveMaker {
   public:
     MoveMaker(Position *position);
@@ -50,6 +74,18 @@ class MoveMaker {
     MoveContext getMoveContext(const Move &move) const;
     void unmakeMove();
     void remakeMove();
+    /**
+     * Search-only make and take back, for legal moves. They leave the game
+     * history alone and keep their undo state in a per-ply stack, so they
+     * must be strictly nested. COPY_MAKE allocates its stack of board
+     * states on the first doMove.
+     */
+    void doMove(const Move &move);
+    void undoMove();
+    uint64_t keyAfter(const Move &move) const;
+    /** Only change it between searches, with no doMove outstanding. */
+    void setMakeMode(SearchMakeMode mode);
+    SearchMakeMode getMakeMode() const { return makeMode; }
     void clearMoveHistory() {
         moveHistory.clear();
         moveCursor = 0;
@@ -61,11 +97,22 @@ class MoveMaker {
     Position *position;
     std::vector<MoveContext> moveHistory;
     int moveCursor = 0;
+    std::array<UndoInfo, MAX_PLY> undoStack;
+    std::vector<BoardState> stateStack;
+    int undoPly = 0;
+    SearchMakeMode makeMode = COPY_MAKE;
     ColoredPiece movePawn(const Move &move);
     ColoredPiece moveKing(const Move &move);
     ColoredPiece moveRook(const Move &move);
     ColoredPiece promotePawn(const Move &move);
     void updateCastleAfterRookCapture(const Move &move);
+    void updateCastlingRights(int from, int to);
+    static CastlingState castlingRightsAfter(CastlingState rights, int from,
+                                             int to);
+    ColoredPiece applyMove(const Move &move);
+    /** Specialized on the moving color, dispatched once per move. */
+    template <Color Us> ColoredPiece applyMove(const Move &move);
+    template <Color Us> void restoreMove(const UndoInfo &undo);
     bool isEnPassant(const Move &move) const;
     bool isCastling(const Move &move) const;
 };
\ No newline at end of file
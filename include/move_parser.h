@@ -22,5 +22,5 @@ class MoveParser {
   private:
     Position *position;
     std::vector<std::pair<Move, std::string>>
-    getMoveSANPairs(std::vector<Move> legalMoves) const;
+    getMoveSANPairs(const MoveList &legalMoves) const;
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+class Engine;
+class Position;
+
+/**
+ * Hands out the legal moves of a search node one at a time, generating
+ * each group only once the previous one is used up: the hash move, captures
+ * that don't lose material (most valuable victim first), the two killer
+ * moves, quiet moves by history score, then the losing captures. A node
+ * that cuts off early never generates its quiet moves.
+ */
+
+class MovePicker {
+  public:
+    /**
+     * @param killers the two quiet moves that last cut off at this ply.
+     * @param history cutoff scores of the side to move, by from and to.
+     */
+    MovePicker(Position *position, const Engine *engine, Move ttMove,
+               const Move killers[2], const int (*history)[64]);
+    /** @returns the next move, or Move() once every move was returned. */
+    Move next();
+    /** Not a capture, en passant or promotion. */
+    bool isQuiet(Move move) const;
+
+  private:
+    enum Stage {
+        TT_MOVE,
+        GENERATE_CAPTURES,
+        GOOD_CAPTURES,
+        KILLERS,
+        GENERATE_QUIETS,
+        QUIETS,
+        BAD_CAPTURES,
+        DONE
+    };
+
+    Position *position;
+    const Engine *engine;
+    Move ttMove;
+    Move killers[2];
+    const int (*history)[64];
+    Stage stage = TT_MOVE;
+
+    MoveList moves;
+    int scores[MAX_MOVES];
+    size_t current = 0;
+    MoveList badCaptures;
+    size_t killerIndex = 0;
+
+    void scoreCaptures();
+    void scoreQuiets();
+    Move pickBest();
+    bool isSearchedEarly(Move move) const;
+};
@@ -1,9 +1,15 @@
 #pragma once
 
+#include "bitboard.h"
 #include "types.h"
-#include <vector>
 class Position;
 
+/**
+ * Which legal moves to generate. Captures include en passant and every
+ * promotion; quiets are all the other moves, castling included.
+ */
+enum GenType { ALL_MOVES, CAPTURES, QUIETS };
+
 /**
  * Checks and generates legal moves for a given position.
  */
@@ -13,8 +19,11 @@ class MovementValidator {
     MovementValidator(Position *position);
     bool isValidMove(const Move &move) const;
     bool isValidPieceMovement(Piece piece, Move move) const;
-    std::vector<Move> getLegalMoves(Color color);
-    std::vector<Move> getLegalMovements(Square from, Color color) const;
+    MoveList getLegalMoves(Color color);
+    MoveList getLegalCaptures(Color color) const;
+    MoveList getLegalQuiets(Color color) const;
+    bool hasAnyLegalMove(Color color) const;
+    MoveList getLegalMovements(Square from, Color color) const;
     
   private:
     Position *position;
@@ -24,13 +33,42 @@ class MovementValidator {
     bool isValidRookMovement(Move move) const;
     bool isValidQueenMovement(Move move) const;
     bool isValidKingMovement(Move move) const;
+    bool isValidPromotion(ColoredPiece movingPiece, Move move) const;
     bool moveLeadsIntoCheck(Move move) const;
-    std::vector<Move> getLegalPawnMovements(Square from, Color color) const;
-    std::vector<Move> getLegalKnightMovements(Square from, Color color) const;
-    std::vector<Move> getLegalBishopMovements(Square from, Color color) const;
-    std::vector<Move> getLegalRookMovements(Square from, Color color) const;
-    std::vector<Move> getLegalQueenMovements(Square from, Color color) const;
-    std::vector<Move> getLegalKingMovements(Square from, Color color) const;
+    Bitboard getPinnedPieces(int kingIndex, Color color) const;
+    template <GenType Type>
+    void generateLegalMoves(Color color, MoveList &legalMoves,
+                            bool stopAtFirst) const;
+    /** Specialized per color, so directions and rank masks are constants. */
+    template <Color Us, GenType Type>
+    void generateLegalMoves(MoveList &legalMoves, bool stopAtFirst) const;
+    template <Color Us, GenType Type = ALL_MOVES>
+    void generatePawnMoves(Bitboard pawns, Bitboard allowed, Bitboard pinned,
+                           int kingIndex, MoveList &moves) const;
+
+    /**
+     * Per-piece generators, appending to `moves`. Targets outside `allowed`
+     * are skipped, which is how getLegalMoves applies check evasion and pin
+     * restrictions.
+     */
+    void getLegalPawnMovements(Square from, Color color, MoveList &moves,
+                               Bitboard allowed = ALL_SQUARES) const;
+    void getLegalKnightMovements(Square from, Color color, MoveList &moves,
+                                 Bitboard allowed = ALL_SQUARES) const;
+    void getLegalBishopMovements(Square from, Color color, MoveList &moves,
+                                 Bitboard allowed = ALL_SQUARES) const;
+    void getLegalRookMovements(Square from, Color color, MoveList &moves,
+                               Bitboard allowed = ALL_SQUARES) const;
+    void getLegalQueenMovements(Square from, Color color, MoveList &moves,
+                                Bitboard allowed = ALL_SQUARES) const;
+    void getLegalKingMovements(Square from, Color color,
+                               MoveList &moves) const;
+    void getSafeKingMovements(Square from, Color color, MoveList &moves,
+                              Bitboard allowed) const;
+    void getCastlingMovements(Square from, Color color,
+                              MoveList &moves) const;
+    void getMovesToTargets(Square from, Bitboard targets,
+                           MoveList &moves) const;
 
     friend class MovementValidatorTest_GetLegalMovements_Test;
 };
\ No newline at end of file
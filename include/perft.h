@@ -0,0 +1,51 @@
+#pragma once
+
+#include "position.h"
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/**
+ * Counts the leaf nodes of the legal move tree to a fixed depth, to check
+ * move generation against known totals and to time it apart from search.
+ * The last ply is bulk counted: its moves are generated but not played.
+ * An optional hash table keyed on the Zobrist hash and depth reuses the
+ * counts of transposed subtrees.
+ *
+ * With more than one thread the root and reply moves are split into
+ * subtrees handed out to workers, each searching its own copy of the root
+ * position with its own share of the hash table.
+ */
+
+class Perft {
+  public:
+    Perft(Position *position, size_t hashSizeMb = 0, unsigned threads = 1);
+    void setHashSize(size_t hashSizeMb);
+    /** 0 uses every hardware thread. */
+    void setThreads(unsigned threads);
+    uint64_t perft(int depth);
+    /** @returns the leaf count below each legal root move. */
+    std::vector<std::pair<Move, uint64_t>> divide(int depth);
+    /**
+     * Runs perft (or divide, listing every root move) and prints the node
+     * count, the time taken and the nodes per second.
+     */
+    uint64_t report(int depth, bool perMove, std::ostream &out);
+
+  private:
+    /** Node count in the high 56 bits, remaining depth in the low 8. */
+    struct HashEntry {
+        uint64_t key;
+        uint64_t data;
+    };
+
+    Position *position;
+    std::vector<HashEntry> table;
+    size_t hashSizeMb = 0;
+    unsigned threads = 1;
+    uint64_t count(int depth);
+    std::vector<std::pair<Move, uint64_t>> parallelDivide(int depth);
+};
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "bitboard.h"
+#include "board_state.h"
 #include "check_scanner.h"
+#include "input_planes.h"
 #include "move_maker.h"
 #include "move_parser.h"
 #include "movement_validator.h"
@@ -21,51 +24,63 @@ class Position {
     CheckScanner scanner;
     MovementValidator movementValidator;
     MoveParser moveParser;
-    uint64_t zobristHash;
     Position();
     Position(const Position &p);
+    const BoardState &getState() const { return state; }
+    uint64_t getZobristHash() const { return state.zobristHash; }
     void loadFEN(const std::string &fen);
     std::string getFEN() const;
-    void loadPiecesSquares();
     void printBoard() const;
-    void addPieceSquare(Square s, Color c);
-    void removePieceSquare(Square s, Color c);
-    ColoredPiece getPiece(Square square) const;
+    ColoredPiece getPiece(Square square) const {
+        return state.pieceAt(squareIndex(square));
+    }
     void setPiece(Square square, ColoredPiece cp);
     void setEnPassantSquare(Square square);
-    void setCastleState(Color color, int state);
+    void setCastleState(Color color, int rights);
     bool getIsGameOver() const;
     void changeTurn();
+    /**
+     * The position information is encoded in the NN input as follows:
+     * 0-11:  white and black pieces planes
+     * 12:    turn
+     * 13-16: castling planes
+     * 17:    en passant plane
+     */
+    InputPlanes getInputPlanes() const;
+    /** NN expects floats: writes the expanded planes to out. */
+    void writeInputTensor(float *out) const;
     std::array<float, 18 * 8 * 8> getInputTensor() const;
     Square getEnPassantSquare() const;
     Color getTurn() const;
     int getCastleState(Color color) const;
     std::unordered_set<Square> getPiecesSquares(Color color) const;
+    Bitboard getPieces(Color color) const {
+        return state.colorBitboards[colorIndex(color)];
+    }
+    Bitboard getPieces(Color color, Piece piece) const {
+        return state.pieceBitboards[bitboardIndex(ColoredPiece(color, piece))];
+    }
+    Bitboard getOccupancy() const {
+        return state.colorBitboards[0] | state.colorBitboards[1];
+    }
+    /** @returns the king's square index, or -1 if the color has no king. */
+    int getKingIndex(Color color) const {
+        Bitboard king = getPieces(color, KING);
+        return king ? lsbIndex(king) : -1;
+    }
+    Square getKingSquare(Color color) const {
+        int index = getKingIndex(color);
+        return (index < 0) ? INVALID_SQUARE : indexToSquare(index);
+    }
     void increaseMoveCounts(const ColoredPiece movingCP,
                             const ColoredPiece capturedCP);
 
   private:
-    /**
-     * NN expects floats, so we store them directly instead of ints.
-     * The position information is encoded in the tensor as follows:
-     * 0-11:  white and black pieces planes
-     * 12:    turn
-     * 13-16: castling planes
-     * 17:    en passant plane
-     */
-    std::array<float, 18 * 8 * 8> inputTensor;
-    ColoredPiece board[8][8];
-    Square enPassantSquare;
-    Color turn;
-    CastlingState castleState;
-    PiecesSquares piecesSquares;
-    int halfmoveClock;
-    int fullmoveNumber;
-    Zobrist zobrist;
+    /** Kept in sync by setPiece, changeTurn and the other setters. */
+    BoardState state;
     void initZobristHash();
-    void initInputTensor();
+    void clearBoard();
     int getCastlingRightsAsIndex(CastlingState state) const;
-    void updateZobristHash(const Move &move, MoveContext context);
 
     /**
     TODO: think about removing friend class, as MoveMaker only uses
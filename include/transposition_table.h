@@ -0,0 +1,116 @@
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Fixed-size transposition table, allocated once and sized in MB. The low
+ * bits of the Zobrist hash select a bucket of one cache line holding
+ * several entries, so a probe touches a single line; the top 16 bits are
+ * kept with each entry to tell the positions sharing a bucket apart.
+ *
+ * Each search bumps a generation counter that is stored in every entry it
+ * writes. When a bucket is full, a new position replaces the entry with the
+ * lowest depth minus a penalty per search since it was written, so stale
+ * entries make way first while deep ones from the last search survive.
+ *
+ * The table may be shared by search threads without locks. An entry is one
+ * 64-bit word, stored next to its key check XORed with that word, both
+ * through relaxed atomics. When two threads write a slot at once, a reader
+ * can see the check of one write and the data of the other; the XOR then
+ * almost never gives back the key and the slot reads as a miss. A rare
+ * false hit, like two positions sharing the 16-bit check, returns a whole
+ * entry of another position and never a mix of two, so its bound is always
+ * valid. Callers must validate its move before playing it.
+ */
+
+/** Bound type of a stored score, in two bits. 0 is left for empty slots. */
+enum NodeType : uint8_t { EXACT = 1, LOWERBOUND = 2, UPPERBOUND = 3 };
+
+/**
+ * Search result packed into 64 bits; with its 16-bit key check a slot
+ * takes 10 bytes. Scores must fit in 16 bits.
+ */
+struct TTEntry {
+    static constexpr int NO_EVAL = INT16_MIN;
+
+    Move bestMove;
+    int16_t score16;
+    int16_t eval16;
+    int8_t depth8;
+    /** Generation in the top six bits, NodeType in the low two. */
+    uint8_t genBound8;
+
+    int score() const { return score16; }
+    /** Static evaluation of the side to move, NO_EVAL if not computed. */
+    int eval() const { return eval16; }
+    int depth() const { return depth8; }
+    NodeType bound() const { return NodeType(genBound8 & 0x3); }
+    bool isEmpty() const { return bound() == 0; }
+};
+
+static_assert(sizeof(TTEntry) == sizeof(uint64_t));
+
+class TranspositionTable {
+  public:
+    static constexpr size_t DEFAULT_SIZE_MB = 16;
+    static constexpr size_t MIN_SIZE_MB = 1;
+    static constexpr size_t MAX_SIZE_MB = 65536;
+    static constexpr int BUCKET_SIZE = 6;
+
+    explicit TranspositionTable(size_t sizeMb = DEFAULT_SIZE_MB);
+    /**
+     * Reallocates to the largest power of two of buckets that fits.
+     * Throws std::bad_alloc, keeping the current table, if memory runs out.
+     */
+    void resize(size_t sizeMb);
+    /**
+     * Zeroes the table, split over the hardware threads when it is large.
+     * Not safe while other threads use the table.
+     */
+    void clear();
+    /** Called once per search, before any store. */
+    void newSearch() { generation8 += GENERATION_DELTA; }
+    /**
+     * Copies the entry stored for the position into `entry`.
+     * @returns false if there is none.
+     */
+    bool probe(uint64_t key, TTEntry &entry) const;
+    void store(uint64_t key, int score, int eval, int depth, NodeType type,
+               Move bestMove);
+    /**
+     * Starts loading the bucket of a position that is about to be probed,
+     * so the cache miss overlaps with the work before the probe.
+     */
+    void prefetch(uint64_t key) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&buckets[bucketIndex(key)]);
+#endif
+    }
+    size_t bucketCount() const { return buckets.size(); }
+
+  private:
+    /** Data words first, so each stays 8-byte aligned for atomic access. */
+    struct alignas(64) Bucket {
+        uint64_t data[BUCKET_SIZE];
+        uint16_t checks[BUCKET_SIZE];
+        char padding[4];
+    };
+    static_assert(sizeof(Bucket) == 64);
+
+    /** Generations step over the bound bits and wrap after 64 searches. */
+    static constexpr uint8_t GENERATION_DELTA = 4;
+    /** Depth a stored entry loses per search since it was written. */
+    static constexpr int AGE_PENALTY = 8;
+
+    std::vector<Bucket> buckets;
+    uint8_t generation8 = 0;
+
+    size_t bucketIndex(uint64_t key) const {
+        return key & (buckets.size() - 1);
+    }
+    static uint16_t keyCheck(uint64_t key) { return key >> 48; }
+    int replacementValue(const TTEntry &entry) const;
+};
@@ -111,36 +111,52 @@ template <> struct hash<Square> {
 
 const Square INVALID_SQUARE = Square(-1, -1);
 
-struct Move {
-    Square from;
-    Square to;
-    ColoredPiece promotionPiece = NO_COLORED_PIECE;
+/**
+ * A move packed into 16 bits: from square in bits 0-5, to square in bits
+ * 6-11 (both row * 8 + col), promotion piece type in bits 12-14 and the
+ * promotion color in bit 15 (set for black). The default move is a8a8,
+ * which no piece can play.
+ */
+class Move {
+  public:
+    Move() : data(0) {}
+
+    Move(Square f, Square t) : data(encodeSquares(f, t)) {}
 
-    Move() : from(INVALID_SQUARE), to(INVALID_SQUARE) {}
+    Move(Square f, Square t, ColoredPiece cp)
+        : data(encodeSquares(f, t) | (uint16_t(cp.piece) << 12) |
+               (cp.color == BLACK ? uint16_t(1 << 15) : 0)) {}
 
-    Move(Square f, Square t) : from(f), to(t) {}
+    int fromIndex() const { return data & 0x3F; }
+    int toIndex() const { return (data >> 6) & 0x3F; }
+    Square from() const { return Square(fromIndex() >> 3, fromIndex() & 7); }
+    Square to() const { return Square(toIndex() >> 3, toIndex() & 7); }
 
-    Move(Square f, Square t, ColoredPiece cp)
-        : from(f), to(t), promotionPiece(cp) {}
+    bool isPromotion() const { return (data >> 12) & 0x7; }
 
-    bool operator==(const Move &other) const {
-        return from == other.from && to == other.to &&
-               promotionPiece == other.promotionPiece;
+    ColoredPiece promotionPiece() const {
+        Piece piece = Piece((data >> 12) & 0x7);
+        if (piece == EMPTY)
+            return NO_COLORED_PIECE;
+        return ColoredPiece((data >> 15) ? BLACK : WHITE, piece);
     }
 
+    bool operator==(const Move &other) const { return data == other.data; }
+
     bool operator!=(const Move &other) const { return !(*this == other); }
 
     std::string toUCI() const {
         std::string uci;
+        Square f = from(), t = to();
 
-        uci += static_cast<char>('a' + from.col);
-        uci += static_cast<char>('1' + (7 - from.row));
+        uci += static_cast<char>('a' + f.col);
+        uci += static_cast<char>('1' + (7 - f.row));
 
-        uci += static_cast<char>('a' + to.col);
-        uci += static_cast<char>('1' + (7 - to.row));
+        uci += static_cast<char>('a' + t.col);
+        uci += static_cast<char>('1' + (7 - t.row));
 
-        if (promotionPiece != NO_COLORED_PIECE) {
-            switch (promotionPiece.piece) {
+        if (isPromotion()) {
+            switch (promotionPiece().piece) {
             case QUEEN:
                 uci += 'q';
                 break;
@@ -160,33 +176,57 @@ struct Move {
 
         return uci;
     }
+
+  private:
+    uint16_t data;
+
+    static uint16_t encodeSquares(Square f, Square t) {
+        return uint16_t((f.row * 8 + f.col) | ((t.row * 8 + t.col) << 6));
+    }
 };
 
-std::string getMoveString(Move move);
-bool vectorContainsMove(std::vector<Move> moves, Move move);
+static_assert(sizeof(Move) == 2);
 
-struct PiecesSquares {
-    std::unordered_set<Square> white;
-    std::unordered_set<Square> black;
+/** No legal chess position has more than 218 moves. */
+constexpr int MAX_MOVES = 256;
 
-    PiecesSquares() : white(), black() {}
-};
+/**
+ * Fixed-capacity list of moves stored inline, so generating moves on the
+ * stack never touches the heap.
+ */
+class MoveList {
+  public:
+    void push_back(Move move) { moves[count++] = move; }
+    void clear() { count = 0; }
 
-constexpr int NUM_PLANES = 18;
-constexpr int BOARD_SIZE = 8;
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move &operator[](size_t i) { return moves[i]; }
+    const Move &operator[](size_t i) const { return moves[i]; }
+
+    Move *begin() { return moves; }
+    Move *end() { return moves + count; }
+    const Move *begin() const { return moves; }
+    const Move *end() const { return moves + count; }
 
-size_t tensorIndex(int plane, int row, int col);
+    bool contains(Move move) const {
+        for (Move m : *this) {
+            if (m == move)
+                return true;
+        }
+        return false;
+    }
 
-void clearAllPlanes(
-    std::array<float, NUM_PLANES * BOARD_SIZE * BOARD_SIZE> &tensor);
+  private:
+    Move moves[MAX_MOVES];
+    size_t count = 0;
+};
 
-void clearPiecePlanes(
-    std::array<float, NUM_PLANES * BOARD_SIZE * BOARD_SIZE> &tensor, int r,
-    int c);
+std::string getMoveString(Move move);
+bool vectorContainsMove(std::vector<Move> moves, Move move);
 
-void setPiecePlane(
-    std::array<float, NUM_PLANES * BOARD_SIZE * BOARD_SIZE> &tensor,
-    const ColoredPiece &cp, int r, int c);
+constexpr int NUM_PLANES = 18;
+constexpr int BOARD_SIZE = 8;
 
-void fillPlane(std::array<float, NUM_PLANES * BOARD_SIZE * BOARD_SIZE> &tensor,
-               int plane, float v);
\ No newline at end of file
+size_t tensorIndex(int plane, int row, int col);
\ No newline at end of file
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "engine.h"
 #include "position.h"
+#include <sstream>
 #include <string>
 
 void parsePositionCommand(const std::string &line, Position &pos);
+void goPerft(std::istringstream &iss, Position &pos);
+void setOption(const std::string &line, Engine &engine);
+void setHashOption(const std::string &value, Engine &engine);
 void uciLoop();
\ No newline at end of file
@@ -1,11 +1,45 @@
 #pragma once
 #include <cstdint>
 
+/**
+ * Zobrist keys, generated at compile time by a SplitMix64 generator with a
+ * fixed seed. Every position hashes with the single ZOBRIST table, so no
+ * keys are generated or stored per position.
+ */
+
 struct Zobrist {
-    uint64_t pieceKeys[12][64];
-    uint64_t sideToMoveKey;
-    uint64_t castlingRightsKey[16];
-    uint64_t enPassantFileKey[8];
+    uint64_t pieceKeys[12][64] = {};
+    uint64_t sideToMoveKey = 0;
+    uint64_t castlingRightsKey[16] = {};
+    uint64_t enPassantFileKey[8] = {};
+
+    constexpr Zobrist() {
+        uint64_t seed = 0xCAFEBABE;
+
+        for (int p = 0; p < 12; ++p) {
+            for (int sq = 0; sq < 64; ++sq) {
+                pieceKeys[p][sq] = next(seed);
+            }
+        }
+
+        for (int i = 0; i < 16; ++i) {
+            castlingRightsKey[i] = next(seed);
+        }
+
+        for (int i = 0; i < 8; ++i) {
+            enPassantFileKey[i] = next(seed);
+        }
+
+        sideToMoveKey = next(seed);
+    }
+
+  private:
+    static constexpr uint64_t next(uint64_t &seed) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
 
-    Zobrist();
-};
\ No newline at end of file
+inline constexpr Zobrist ZOBRIST;
@@ -0,0 +1,239 @@
+#include "attacks.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHESS_X86_64 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+SliderBackend sliderBackend = MAGIC_SLIDERS;
+Magic rookMagics[64];
+Magic bishopMagics[64];
+
+namespace {
+
+Bitboard magicRookAttacks(int square, Bitboard occupancy) {
+    const Magic &m = rookMagics[square];
+    return m.attacks[m.index(occupancy)];
+}
+
+Bitboard magicBishopAttacks(int square, Bitboard occupancy) {
+    const Magic &m = bishopMagics[square];
+    return m.attacks[m.index(occupancy)];
+}
+
+#ifdef CHESS_X86_64
+// Compiled for BMI2 so _pext_u64 inlines; only reached once the CPU has it
+__attribute__((target("bmi2"))) unsigned pextIndex(Bitboard occupancy,
+                                                   Bitboard mask) {
+    return static_cast<unsigned>(_pext_u64(occupancy, mask));
+}
+
+__attribute__((target("bmi2"))) Bitboard pextRookAttacks(int square,
+                                                         Bitboard occupancy) {
+    const Magic &m = rookMagics[square];
+    return m.attacks[_pext_u64(occupancy, m.mask)];
+}
+
+__attribute__((target("bmi2"))) Bitboard
+pextBishopAttacks(int square, Bitboard occupancy) {
+    const Magic &m = bishopMagics[square];
+    return m.attacks[_pext_u64(occupancy, m.mask)];
+}
+#endif
+
+} // namespace
+
+// Constant-initialized, so lookups work even during static initialization
+SliderLookup rookLookup = magicRookAttacks;
+SliderLookup bishopLookup = magicBishopAttacks;
+
+namespace {
+
+// Sum over all squares of 2^(relevant blocker bits)
+Bitboard rookTable[0x19000];
+Bitboard bishopTable[0x1480];
+
+const int ROOK_DIRECTIONS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+const int BISHOP_DIRECTIONS[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+bool isOnBoard(int row, int col) {
+    return row >= 0 && row < 8 && col >= 0 && col < 8;
+}
+
+/**
+ * Reference ray walk, only used to fill the tables.
+ */
+Bitboard slidingAttacks(const int directions[4][2], int square,
+                        Bitboard occupancy) {
+    Bitboard attacks = EMPTY_BITBOARD;
+    for (int d = 0; d < 4; ++d) {
+        int dr = directions[d][0], dc = directions[d][1];
+        int r = (square >> 3) + dr, c = (square & 7) + dc;
+        while (isOnBoard(r, c)) {
+            Bitboard bit = squareBitboard(r * 8 + c);
+            attacks |= bit;
+            if (occupancy & bit)
+                break;
+            r += dr;
+            c += dc;
+        }
+    }
+    return attacks;
+}
+
+/**
+ * Squares whose occupancy can change the attack set: every ray square except
+ * the last one, since a piece on the board edge never blocks anything.
+ */
+Bitboard relevantBlockers(const int directions[4][2], int square) {
+    Bitboard mask = EMPTY_BITBOARD;
+    for (int d = 0; d < 4; ++d) {
+        int dr = directions[d][0], dc = directions[d][1];
+        int r = (square >> 3) + dr, c = (square & 7) + dc;
+        while (isOnBoard(r + dr, c + dc)) {
+            mask |= squareBitboard(r * 8 + c);
+            r += dr;
+            c += dc;
+        }
+    }
+    return mask;
+}
+
+/**
+ * Magic numbers for the row-major square layout, found offline by trial with
+ * a fixed-seed sparse random generator. Each one maps every blocker subset of
+ * its square's mask to a distinct (or attack-equivalent) table slot.
+ */
+const Bitboard ROOK_MAGICS[64] = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL,
+    0x0880100008000480ULL, 0x4200100420080200ULL, 0x8100020100080400ULL,
+    0x0200040110886200ULL, 0x0200008040220411ULL, 0x0404800084400220ULL,
+    0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL,
+    0x0442000102105084ULL, 0x9080010020804100ULL, 0x0040404000201009ULL,
+    0x0000808010002009ULL, 0x2200090021D00100ULL, 0x0008008008040080ULL,
+    0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL,
+    0x1000100080080080ULL, 0x0442000A00049020ULL, 0x2100040080020080ULL,
+    0x0800120400900148ULL, 0x0010040A00128541ULL, 0x2800804000800030ULL,
+    0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL,
+    0x0182085882000401ULL, 0x0220204000808000ULL, 0x2860100040024022ULL,
+    0x0001002004110040ULL, 0x99101042000A0020ULL, 0x0004080004008080ULL,
+    0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL,
+    0x0801100280080480ULL, 0x0242009008200600ULL, 0x1002000489500200ULL,
+    0x0040800200010080ULL, 0x0091800041000080ULL, 0x0000209300488001ULL,
+    0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL,
+    0x4000002840840112ULL,
+};
+
+const Bitboard BISHOP_MAGICS[64] = {
+    0x10102002004A1420ULL, 0x8020040400584008ULL, 0x10510800811201C8ULL,
+    0x5204042080000088ULL, 0x2204106880000002ULL, 0x1401042004000000ULL,
+    0x0400880410042004ULL, 0x0028208200A02020ULL, 0x1500241990010E00ULL,
+    0x8001200182020A40ULL, 0x40004101030B0000ULL, 0x8002041042000100ULL,
+    0x4010011041020038ULL, 0x0000010421044000ULL, 0x1500210808020A00ULL,
+    0x8000088400880520ULL, 0x0405004010040100ULL, 0x1005823210040108ULL,
+    0x2708008102040011ULL, 0x4048200404009100ULL, 0x0018104101400024ULL,
+    0x0003000601190101ULL, 0x8004803108491000ULL, 0x8014241200820800ULL,
+    0x0006E080100C3040ULL, 0x0501044A11041800ULL, 0x9020300008004045ULL,
+    0x0894080000220040ULL, 0x1001010083104000ULL, 0x5004030040900080ULL,
+    0x000400422C012400ULL, 0x0002128698404812ULL, 0x1010108404900440ULL,
+    0x0928021182084100ULL, 0x2006080409020024ULL, 0x1010202020180080ULL,
+    0xA010008200202200ULL, 0x2098015100019004ULL, 0x0002041440810811ULL,
+    0x802A02020000B098ULL, 0x0009015090004060ULL, 0x4000821082081001ULL,
+    0x0100210040420800ULL, 0x0800004010488A00ULL, 0x2000081104004040ULL,
+    0x4C8E029015000082ULL, 0x0420340322224842ULL, 0x1298260043400210ULL,
+    0x0000822802400008ULL, 0x00008A0101600000ULL, 0x3040003412080021ULL,
+    0x3040290220884800ULL, 0x4A1500401041004AULL, 0x8010200282020781ULL,
+    0x0020203142209091ULL, 0x0070300600902110ULL, 0x0040808800B62048ULL,
+    0x0000810400C44420ULL, 0x00080400440C0441ULL, 0x8340080020840411ULL,
+    0x0000000104208200ULL, 0x0000800810D00080ULL, 0x0400530411080200ULL,
+    0x4040702400932244ULL,
+};
+
+/**
+ * Fills the shared attack table, enumerating every blocker subset of each
+ * square's mask and storing the attack set at its magic index.
+ */
+void initMagics(const int directions[4][2], const Bitboard magicNumbers[64],
+                Magic magics[64], Bitboard *table, SliderBackend backend) {
+    Bitboard *next = table;
+
+    for (int square = 0; square < 64; ++square) {
+        Magic &m = magics[square];
+        m.mask = relevantBlockers(directions, square);
+        m.magic = magicNumbers[square];
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = next;
+
+        // Carry-Rippler enumeration of every subset of the mask
+        Bitboard subset = EMPTY_BITBOARD;
+        do {
+#ifdef CHESS_X86_64
+            unsigned index = (backend == PEXT_SLIDERS)
+                                 ? pextIndex(subset, m.mask)
+                                 : m.index(subset);
+#else
+            unsigned index = m.index(subset);
+#endif
+            m.attacks[index] = slidingAttacks(directions, square, subset);
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+        next += 1 << popCount(m.mask);
+    }
+}
+
+struct AttackTablesInitializer {
+    AttackTablesInitializer() {
+        initSliderAttacks(cpuHasFastPext() ? PEXT_SLIDERS : MAGIC_SLIDERS);
+    }
+};
+
+AttackTablesInitializer attackTablesInitializer;
+
+} // namespace
+
+bool cpuHasFastPext() {
+#ifdef CHESS_X86_64
+    // May run from a static initializer, before the runtime has probed the CPU
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("bmi2"))
+        return false;
+
+    // AMD implemented PEXT in microcode before Zen 3, slower than magics there
+    if (__builtin_cpu_is("amd")) {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return false;
+        unsigned family = ((eax >> 8) & 0xF) + ((eax >> 20) & 0xFF);
+        return family >= 0x19;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool initSliderAttacks(SliderBackend backend) {
+    if (backend == PEXT_SLIDERS && !cpuHasFastPext())
+        return false;
+
+    sliderBackend = backend;
+    initMagics(ROOK_DIRECTIONS, ROOK_MAGICS, rookMagics, rookTable, backend);
+    initMagics(BISHOP_DIRECTIONS, BISHOP_MAGICS, bishopMagics, bishopTable,
+               backend);
+#ifdef CHESS_X86_64
+    if (backend == PEXT_SLIDERS) {
+        rookLookup = pextRookAttacks;
+        bishopLookup = pextBishopAttacks;
+        return true;
+    }
+#endif
+    rookLookup = magicRookAttacks;
+    bishopLookup = magicBishopAttacks;
+    return true;
+}
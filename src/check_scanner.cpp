@@ -1,110 +1,65 @@
 #include "check_scanner.h"
+#include "attacks.h"
 #include "position.h"
 #include "types.h"
 
 CheckScanner::CheckScanner(Position *position) : position(position) {}
 
 bool CheckScanner::isInCheck(Color color) const {
-    Square kingSquare = getKingSquare(color);
-
-    return isSquareInCheck(kingSquare, color);
-}
-
-Square CheckScanner::getKingSquare(Color color) const {
-    ColoredPiece king = ColoredPiece(color, KING);
-
-    std::unordered_set<Square> piecesSquares =
-        position->getPiecesSquares(color);
+    int kingIndex = position->getKingIndex(color);
+    if (kingIndex < 0)
+        return false;
 
-    for (Square square : piecesSquares) {
-        if (position->getPiece(square) == king) {
-            return square;
-        }
-    }
-    return INVALID_SQUARE;
+    Color opponent = (color == WHITE) ? BLACK : WHITE;
+    return attackersTo(kingIndex, position->getOccupancy()) &
+           position->getPieces(opponent);
 }
 
 bool CheckScanner::isInCheckmate(Color color) const {
-    if (!isInCheck(color))
-        return false;
-    return !areThereLegalMoves(color);
+    return getGameStatus(color) == CHECKMATE;
 }
 
 bool CheckScanner::isInStalemate(Color color) const {
-    if (isInCheck(color))
-        return false;
-    return !areThereLegalMoves(color);
+    return getGameStatus(color) == STALEMATE;
 }
 
-bool CheckScanner::areThereLegalMoves(Color color) const {
-    std::unordered_set<Square> piecesSquares =
-        position->getPiecesSquares(color);
-    for (Square from : piecesSquares) {
-        ColoredPiece cp = position->getPiece(from);
-        if (cp.color != color)
-            continue;
-
-        for (int targetRow = 0; targetRow < 8; ++targetRow) {
-            for (int targetCol = 0; targetCol < 8; ++targetCol) {
-                Move move(from, Square(targetRow, targetCol), NO_COLORED_PIECE);
-                if (cp.piece == PAWN) {
-                    // Handle pawn promotion
-                    int promotionRow = (cp.color == WHITE) ? 0 : 7;
-                    if (targetRow == promotionRow) {
-                        for (const Piece &promotionPiece :
-                             {QUEEN, ROOK, BISHOP, KNIGHT}) {
-                            move.promotionPiece =
-                                ColoredPiece(cp.color, promotionPiece);
-                            if (position->movementValidator.isValidMove(move)) {
-                                return true;
-                            }
-                        }
-                    } else if (position->movementValidator.isValidMove(move)) {
-                        return true;
-                    }
-                } else if (position->movementValidator.isValidMove(move)) {
-                    return true;
-                }
-            }
-        }
-    }
-
-    return false;
+/**
+ * Looks for a single legal move first: when there is one, which is almost
+ * always, the check scan is skipped entirely.
+ */
+GameStatus CheckScanner::getGameStatus(Color color) const {
+    if (position->movementValidator.hasAnyLegalMove(color))
+        return IN_PROGRESS;
+    return isInCheck(color) ? CHECKMATE : STALEMATE;
 }
 
 bool CheckScanner::isSquareInCheck(Square target, Color color) const {
     Color opponent = (color == WHITE) ? BLACK : WHITE;
-    std::unordered_set<Square> opponentPiecesSquares =
-        position->getPiecesSquares(opponent);
-
-    for (Square from : opponentPiecesSquares) {
-        ColoredPiece cp = position->getPiece(from);
-        if (cp.color == color || cp == NO_COLORED_PIECE)
-            continue;
+    return attackersTo(squareIndex(target), position->getOccupancy()) &
+           position->getPieces(opponent);
+}
 
-        Move move(from, target);
-        if (cp.piece == PAWN) {
-            // Handle pawn promotion
-            int promotionRow = (cp.color == WHITE) ? 0 : 7;
-            if (target.row == promotionRow) {
-                for (const Piece &promotionPiece :
-                     {QUEEN, ROOK, BISHOP, KNIGHT}) {
-                    move.promotionPiece =
-                        ColoredPiece(cp.color, promotionPiece);
-                    if (position->movementValidator.isValidPieceMovement(
-                            cp.piece, move)) {
-                        return true;
-                    }
-                }
-            } else if (position->movementValidator.isValidPieceMovement(
-                           cp.piece, move)) {
-                return true;
-            }
-        } else if (position->movementValidator.isValidPieceMovement(cp.piece,
-                                                                    move)) {
-            return true;
-        }
-    }
+/**
+ * @returns the pieces of both colors attacking the square. Every attack is
+ * looked up outwards from the target: a piece attacks it exactly when the
+ * same piece type standing on the target would attack the piece. Sliders see
+ * through anything not in the occupancy, which lets callers lift pieces off
+ * the board (a king stepping away from a slider, SEE x-rays).
+ */
+Bitboard CheckScanner::attackersTo(int square, Bitboard occupancy) const {
+    Bitboard queens =
+        position->getPieces(WHITE, QUEEN) | position->getPieces(BLACK, QUEEN);
+    Bitboard rookLike = position->getPieces(WHITE, ROOK) |
+                        position->getPieces(BLACK, ROOK) | queens;
+    Bitboard bishopLike = position->getPieces(WHITE, BISHOP) |
+                          position->getPieces(BLACK, BISHOP) | queens;
 
-    return false;
-}
\ No newline at end of file
+    return (pawnAttacks(BLACK, square) & position->getPieces(WHITE, PAWN)) |
+           (pawnAttacks(WHITE, square) & position->getPieces(BLACK, PAWN)) |
+           (knightAttacks(square) & (position->getPieces(WHITE, KNIGHT) |
+                                     position->getPieces(BLACK, KNIGHT))) |
+           (kingAttacks(square) & (position->getPieces(WHITE, KING) |
+                                   position->getPieces(BLACK, KING))) |
+           (rookAttacks(square, occupancy) & rookLike) |
+           (bishopAttacks(square, occupancy) & bishopLike);
+}
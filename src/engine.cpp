@@ -1,11 +1,53 @@
 #include "engine.h"
+#include "attacks.h"
+#include "move_picker.h"
 #include "types.h"
 #include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <unordered_map>
 
 std::unordered_map<uint64_t, Move> principalVariation;
 
-Engine::Engine(Position *position) { this->position = position; }
+Engine::Engine(Position *position) {
+    this->position = position;
+    clearMoveOrdering();
+}
+
+void Engine::setHashSize(size_t sizeMb) { transpositionTable.resize(sizeMb); }
+
+void Engine::setMakeMode(SearchMakeMode mode) {
+    position->moveMaker.setMakeMode(mode);
+}
+
+/**
+ * Forgets everything learned in the previous game. Between moves of one
+ * game the table is kept and only aged.
+ */
+void Engine::newGame() { transpositionTable.clear(); }
+
+void Engine::clearMoveOrdering() {
+    for (auto &killers : killerMoves)
+        killers[0] = killers[1] = Move();
+    std::memset(history, 0, sizeof(history));
+}
+
+/**
+ * A quiet move refuting the previous move is likely to refute its siblings
+ * too: it becomes the first killer of the ply and gains history. The gain
+ * shrinks as the score nears HISTORY_MAX, which it never passes however
+ * long or deep the search runs.
+ */
+void Engine::recordCutoff(const Move &move, int depth, int ply) {
+    if (ply < MAX_PLY && killerMoves[ply][0] != move) {
+        killerMoves[ply][1] = killerMoves[ply][0];
+        killerMoves[ply][0] = move;
+    }
+    Color color = position->getTurn();
+    int &score = history[colorIndex(color)][move.fromIndex()][move.toIndex()];
+    int bonus = std::min(depth * depth, HISTORY_MAX);
+    score += bonus - score * bonus / HISTORY_MAX;
+}
 
 Move Engine::getBestMove() {
     principalVariation.clear();
@@ -25,17 +67,18 @@ Move Engine::getBestMove() {
 Move Engine::getBestMoveWithTimeLimit(int timeLimitMs) {
     this->timeLimitMs = timeLimitMs;
     this->startTime = std::chrono::steady_clock::now();
+    clearMoveOrdering();
+    transpositionTable.newSearch();
 
     Move bestMove;
     int maxDepthReached = 0;
     Color color = position->getTurn();
 
-    for (int depth = 1; depth <= INF; ++depth) {
+    for (int depth = 1; depth <= MAX_SEARCH_DEPTH; ++depth) {
         Move currentBest;
         int currentBestScore = -INF;
 
-        std::vector<Move> moves =
-            position->movementValidator.getLegalMoves(color);
+        MoveList moves = position->movementValidator.getLegalMoves(color);
 
         std::sort(moves.begin(), moves.end(),
                   [this](const Move &a, const Move &b) {
@@ -46,10 +89,11 @@ Move Engine::getBestMoveWithTimeLimit(int timeLimitMs) {
             if (isTimeUp())
                 return bestMove;
 
-            position->moveMaker.makeLegalMove(move);
-            int score =
-                -negamax(position, depth - 1, -INF, INF, oppositeColor(color));
-            position->moveMaker.unmakeMove();
+            transpositionTable.prefetch(position->moveMaker.keyAfter(move));
+            position->moveMaker.doMove(move);
+            int score = -negamax(position, depth - 1, -INF, INF,
+                                 oppositeColor(color), 1);
+            position->moveMaker.undoMove();
 
             if (score > currentBestScore) {
                 currentBest = move;
@@ -78,21 +122,24 @@ Move Engine::minimax() {
     Color color = position->getTurn();
     int alpha = -INF;
     int beta = INF;
+    clearMoveOrdering();
+    transpositionTable.newSearch();
 
     Move bestMove = Move(Square(0, 0), Square(0, 0));
     int bestScore = -INF;
 
-    std::vector<Move> moves = position->movementValidator.getLegalMoves(color);
+    MoveList moves = position->movementValidator.getLegalMoves(color);
 
     std::sort(moves.begin(), moves.end(), [this](const Move &a, const Move &b) {
         return scoreMove(a, position) > scoreMove(b, position);
     });
 
     for (const Move &move : moves) {
-        position->moveMaker.makeLegalMove(move);
-        int score =
-            -negamax(position, depth - 1, -beta, -alpha, oppositeColor(color));
-        position->moveMaker.unmakeMove();
+        transpositionTable.prefetch(position->moveMaker.keyAfter(move));
+        position->moveMaker.doMove(move);
+        int score = -negamax(position, depth - 1, -beta, -alpha,
+                             oppositeColor(color), 1);
+        position->moveMaker.undoMove();
 
         if (score > bestScore) {
             bestScore = score;
@@ -106,67 +153,58 @@ Move Engine::minimax() {
 
 /**
  * Negamax implementation of minimax, with alpha-beta pruning,
- * hashmap of already-seen positions, and move ordering selection.
+ * hashmap of already-seen positions, and staged move ordering.
  */
 int Engine::negamax(Position *position, int depth, int alpha, int beta,
-                    Color color) {
+                    Color color, int ply) {
     if (isTimeUp())
         return 0;
     int alphaOrig = alpha;
-    uint64_t hash = position->zobristHash;
+    uint64_t hash = position->getZobristHash();
+    Move ttMove;
 
     // Transposition table lookup
-    auto ttIt = transpositionTable.find(hash);
-    if (ttIt != transpositionTable.end()) {
-        const TTEntry &entry = ttIt->second;
-        if (entry.depth >= depth) {
-            switch (entry.type) {
+    if (TTEntry entry; transpositionTable.probe(hash, entry)) {
+        ttMove = entry.bestMove;
+        if (entry.depth() >= depth) {
+            switch (entry.bound()) {
             case EXACT:
-                return entry.score;
+                return entry.score();
             case LOWERBOUND:
-                alpha = std::max(alpha, entry.score);
+                alpha = std::max(alpha, entry.score());
                 break;
             case UPPERBOUND:
-                beta = std::min(beta, entry.score);
+                beta = std::min(beta, entry.score());
                 break;
             }
             if (alpha >= beta)
-                return entry.score;
+                return entry.score();
         }
     }
 
-    if (depth == 0 || position->getIsGameOver()) {
-        int eval = quiescence(position, -INF, INF, color, MAX_DEPTH - depth);
-        transpositionTable[hash] = TTEntry{
-            .score = eval, .depth = depth, .type = EXACT, .bestMove = Move()};
+    if (depth == 0) {
+        int eval = quiescence(position, -INF, INF, color, ply);
+        transpositionTable.store(hash, eval, staticEval(position, color), depth,
+                                 EXACT, Move());
         return eval;
     }
 
     int maxEval = -INF;
     Move bestMove;
+    int moveCount = 0;
 
-    std::vector<Move> moves =
-        position->movementValidator.getLegalMoves(position->getTurn());
-
-    // PV move ordering from TT
-    auto pvIt = transpositionTable.find(position->zobristHash);
-    if (pvIt != transpositionTable.end()) {
-        const Move &pvMove = pvIt->second.bestMove;
-        auto it = std::find(moves.begin(), moves.end(), pvMove);
-        if (it != moves.end())
-            std::iter_swap(moves.begin(), it);
-    }
-
-    std::sort(moves.begin(), moves.end(),
-              [this, position](const Move &a, const Move &b) {
-                  return scoreMove(a, position) > scoreMove(b, position);
-              });
+    MovePicker picker(position, this, ttMove,
+                      killerMoves[std::min(ply, MAX_PLY - 1)],
+                      history[colorIndex(position->getTurn())]);
+    for (Move move = picker.next(); move != Move(); move = picker.next()) {
+        ++moveCount;
+        bool isQuiet = picker.isQuiet(move);
 
-    for (const Move &move : moves) {
-        position->moveMaker.makeLegalMove(move);
-        int eval =
-            -negamax(position, depth - 1, -beta, -alpha, oppositeColor(color));
-        position->moveMaker.unmakeMove();
+        transpositionTable.prefetch(position->moveMaker.keyAfter(move));
+        position->moveMaker.doMove(move);
+        int eval = -negamax(position, depth - 1, -beta, -alpha,
+                            oppositeColor(color), ply + 1);
+        position->moveMaker.undoMove();
 
         if (eval > maxEval) {
             maxEval = eval;
@@ -174,8 +212,22 @@ int Engine::negamax(Position *position, int depth, int alpha, int beta,
         }
 
         alpha = std::max(alpha, eval);
-        if (alpha >= beta)
+        if (alpha >= beta) {
+            if (isQuiet)
+                recordCutoff(move, depth, ply);
             break;
+        }
+    }
+
+    // No legal move: the game is over
+    if (moveCount == 0) {
+        GameStatus status = position->scanner.isInCheck(position->getTurn())
+                                ? CHECKMATE
+                                : STALEMATE;
+        int eval = evaluateLeaf(position, color, ply, status);
+        transpositionTable.store(hash, eval, staticEval(position, color), depth,
+                                 EXACT, Move());
+        return eval;
     }
 
     NodeType nodeType = EXACT;
@@ -184,10 +236,8 @@ int Engine::negamax(Position *position, int depth, int alpha, int beta,
     else if (maxEval >= beta)
         nodeType = LOWERBOUND;
 
-    transpositionTable[hash] = TTEntry{.score = maxEval,
-                                       .depth = depth,
-                                       .type = nodeType,
-                                       .bestMove = bestMove};
+    transpositionTable.store(hash, maxEval, staticEval(position, color), depth,
+                             nodeType, bestMove);
 
     return maxEval;
 }
@@ -196,21 +246,31 @@ int Engine::negamax(Position *position, int depth, int alpha, int beta,
  * Simple material-based evaluation (positive for white, negative for black).
  */
 int Engine::evaluate(Position *position) const {
-    int score = 0;
-    Color color = position->getTurn();
-    if (position->scanner.isInCheckmate(color)) {
-        bool isWhitesTurn = position->getTurn() == WHITE;
-        score = isWhitesTurn ? -MATE_SCORE : MATE_SCORE;
-        return score;
-    } else if (position->scanner.isInStalemate(color)) {
+    switch (position->scanner.getGameStatus(position->getTurn())) {
+    case CHECKMATE:
+        return (position->getTurn() == WHITE) ? -MATE_SCORE : MATE_SCORE;
+    case STALEMATE:
         return 0;
+    default:
+        return evaluateMaterial(position);
     }
+}
 
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            ColoredPiece cp = position->getPiece(Square(row, col));
-            score += getPieceValue(cp);
-        }
+/**
+ * Material balance from the side of the given color, without the game
+ * status check of evaluateLeaf.
+ */
+int Engine::staticEval(Position *position, Color color) const {
+    int score = evaluateMaterial(position);
+    return (color == WHITE) ? score : -score;
+}
+
+int Engine::evaluateMaterial(Position *position) const {
+    int score = 0;
+    for (Piece piece : {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING}) {
+        int count = popCount(position->getPieces(WHITE, piece)) -
+                    popCount(position->getPieces(BLACK, piece));
+        score += getPieceValue(ColoredPiece(WHITE, piece)) * count;
     }
 
     return score;
@@ -221,20 +281,40 @@ int Engine::evaluate(Position *position) const {
  */
 int Engine::evaluateLeaf(Position *position, Color color,
                          int plyFromRoot) const {
+    return evaluateLeaf(position, color, plyFromRoot,
+                        position->scanner.getGameStatus(position->getTurn()));
+}
+
+/**
+ * Same as above, with the game status of the side to move already known.
+ */
+int Engine::evaluateLeaf(Position *position, Color color, int plyFromRoot,
+                         GameStatus status) const {
     Color current = position->getTurn();
-    if (position->scanner.isInCheckmate(current)) {
+    if (status == CHECKMATE) {
         int mateScore = MATE_SCORE - plyFromRoot;
         return (current == color) ? -mateScore : mateScore;
     }
 
-    if (position->scanner.isInStalemate(current)) {
+    if (status == STALEMATE) {
         return 0;
     }
 
-    int score = evaluate(position);
+    int score = evaluateMaterial(position);
     return (color == WHITE) ? score : -score;
 }
 
+/**
+ * Game status for the side to move, reusing its already generated moves.
+ */
+GameStatus Engine::getGameStatus(Position *position,
+                                 const MoveList &legalMoves) const {
+    if (!legalMoves.empty())
+        return IN_PROGRESS;
+    return position->scanner.isInCheck(position->getTurn()) ? CHECKMATE
+                                                            : STALEMATE;
+}
+
 int Engine::getPieceValue(const ColoredPiece &cp) const {
     int value = 0;
     int colorMultiplier = (cp.color == WHITE) ? 1 : -1;
@@ -266,8 +346,8 @@ int Engine::getPieceValue(const ColoredPiece &cp) const {
 }
 
 int Engine::scoreMove(const Move &move, const Position *pos) const {
-    ColoredPiece attacker = pos->getPiece(Square(move.from.row, move.from.col));
-    ColoredPiece victim = pos->getPiece(Square(move.to.row, move.to.col));
+    ColoredPiece attacker = pos->getPiece(Square(move.from().row, move.from().col));
+    ColoredPiece victim = pos->getPiece(Square(move.to().row, move.to().col));
 
     int attackerVal = std::abs(getPieceValue(attacker));
     int victimVal = std::abs(getPieceValue(victim));
@@ -276,8 +356,8 @@ int Engine::scoreMove(const Move &move, const Position *pos) const {
         return 10000 + (victimVal - attackerVal);
     }
 
-    if (move.promotionPiece != NO_COLORED_PIECE) {
-        return 9000 + std::abs(getPieceValue(move.promotionPiece));
+    if (move.isPromotion()) {
+        return 9000 + std::abs(getPieceValue(move.promotionPiece()));
     }
 
     return 0;
@@ -289,23 +369,28 @@ int Engine::scoreMove(const Move &move, const Position *pos) const {
  */
 int Engine::quiescence(Position *position, int alpha, int beta, Color color,
                        int plyFromRoot) {
-    int stand_pat = evaluateLeaf(position, color, plyFromRoot);
+    MoveList moves = position->movementValidator.getLegalMoves(color);
+
+    int stand_pat = evaluateLeaf(position, color, plyFromRoot,
+                                 getGameStatus(position, moves));
 
     if (stand_pat >= beta)
         return beta;
     if (alpha < stand_pat)
         alpha = stand_pat;
+    // The capture sequence has run as deep as the move stack allows
+    if (plyFromRoot >= MAX_PLY - 1)
+        return alpha;
 
-    std::vector<Move> moves = position->movementValidator.getLegalMoves(color);
-
-    std::vector<Move> noisyMoves;
+    MoveList noisyMoves;
     for (const Move &move : moves) {
         ColoredPiece target =
-            position->getPiece(Square(move.to.row, move.to.col));
+            position->getPiece(Square(move.to().row, move.to().col));
         bool isCapture = target != NO_COLORED_PIECE;
-        bool isGoodCapture = staticExchangeEval(position, move.to, color) >= 0;
-        if ((isCapture && isGoodCapture) ||
-            move.promotionPiece != NO_COLORED_PIECE) {
+        bool isGoodCapture =
+            isCapture && staticExchangeEval(position, move) >= 0;
+        if (isGoodCapture ||
+            move.isPromotion()) {
             noisyMoves.push_back(move);
         }
     }
@@ -316,10 +401,10 @@ int Engine::quiescence(Position *position, int alpha, int beta, Color color,
               });
 
     for (const Move &move : noisyMoves) {
-        position->moveMaker.makeLegalMove(move);
+        position->moveMaker.doMove(move);
         int score = -quiescence(position, -beta, -alpha, oppositeColor(color),
                                 plyFromRoot + 1);
-        position->moveMaker.unmakeMove();
+        position->moveMaker.undoMove();
 
         if (score >= beta)
             return beta;
@@ -330,66 +415,105 @@ int Engine::quiescence(Position *position, int alpha, int beta, Color color,
     return alpha;
 }
 
-int Engine::staticExchangeEval(Position *pos, Square target, Color sideToMove) {
-    Position position = *pos;
-    std::vector<int> gains;
-    int gain = 0;
-
-    auto attackers = getSortedAttackers(&position, target);
-
-    Color currentSide = sideToMove;
-
-    while (!attackers.empty()) {
-        auto [from, attacker] = attackers.front();
-        attackers.erase(attackers.begin());
+/**
+ * Static exchange evaluation of the capture sequence on the target square,
+ * started by sideToMove, with each side recapturing with its least valuable
+ * attacker. Pieces are lifted from a local occupancy instead of being moved,
+ * so sliders lined up behind them join the exchange as x-rays.
+ * @returns the material outcome for sideToMove (0 if it cannot capture).
+ */
+int Engine::staticExchangeEval(Position *pos, Square target,
+                               Color sideToMove) const {
+    int targetIndex = squareIndex(target);
+    Bitboard attackers =
+        pos->scanner.attackersTo(targetIndex, pos->getOccupancy());
+    Piece attacker = EMPTY;
+    Bitboard from =
+        getLeastValuableAttacker(pos, attackers, sideToMove, attacker);
+    if (!from)
+        return 0;
+    return exchange(pos, targetIndex, sideToMove, from, attacker);
+}
 
-        ColoredPiece target_piece = position.getPiece(target);
-        gain = getPieceValue(target_piece) - gain;
-        gains.push_back(gain);
+/**
+ * Static exchange evaluation of the move, opened by the moving piece
+ * itself rather than by the cheapest attacker of the target square.
+ * @returns the material outcome for the side playing the move.
+ */
+int Engine::staticExchangeEval(Position *pos, const Move &move) const {
+    ColoredPiece mover = pos->getPiece(move.from());
+    return exchange(pos, move.toIndex(), mover.color,
+                    squareBitboard(move.from()), mover.piece);
+}
 
-        Move move;
-        move.from = from, move.to = target;
-        position.moveMaker.movePiece(move);
+/**
+ * Plays out the exchange on the target square once the first capture,
+ * by `attacker` standing on `from`, is chosen; both sides then recapture
+ * with their least valuable attacker.
+ */
+int Engine::exchange(Position *pos, int targetIndex, Color sideToMove,
+                     Bitboard from, Piece attacker) const {
+    Bitboard occupancy = pos->getOccupancy();
+    Bitboard attackers = pos->scanner.attackersTo(targetIndex, occupancy);
+
+    Bitboard queens = pos->getPieces(WHITE, QUEEN) | pos->getPieces(BLACK, QUEEN);
+    Bitboard rookLike =
+        pos->getPieces(WHITE, ROOK) | pos->getPieces(BLACK, ROOK) | queens;
+    Bitboard bishopLike =
+        pos->getPieces(WHITE, BISHOP) | pos->getPieces(BLACK, BISHOP) | queens;
+
+    int gains[32];
+    int depth = 0;
+    gains[0] = std::abs(getPieceValue(
+        pos->getPiece(Square(targetIndex >> 3, targetIndex & 7))));
+
+    Color side = sideToMove;
+    while (from) {
+        // The king may only take when nothing recaptures
+        if (attacker == KING && (attackers & pos->getPieces(oppositeColor(side))))
+            break;
 
-        attackers = getSortedAttackers(&position, target);
-        currentSide = oppositeColor(currentSide);
+        depth++;
+        gains[depth] =
+            std::abs(getPieceValue(ColoredPiece(side, attacker))) -
+            gains[depth - 1];
+
+        // Only a slider behind the capturer, on its line to the target, can
+        // join in; knights are never aligned
+        occupancy ^= from;
+        Bitboard behind = lineThrough(targetIndex, lsbIndex(from));
+        if (behind)
+            attackers |= ((rookAttacks(targetIndex, occupancy) & rookLike) |
+                          (bishopAttacks(targetIndex, occupancy) & bishopLike)) &
+                         behind;
+        attackers &= occupancy;
+
+        side = oppositeColor(side);
+        from = getLeastValuableAttacker(pos, attackers, side, attacker);
     }
 
-    for (int i = gains.size() - 2; i >= 0; --i) {
-        gains[i] = std::min(-gains[i + 1], gains[i]);
-    }
+    if (depth == 0)
+        return 0;
+    while (--depth)
+        gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
 
-    return gains.empty() ? 0 : gains[0];
+    return gains[0];
 }
 
-std::vector<std::pair<Square, ColoredPiece>>
-Engine::getSortedAttackers(Position *pos, Square target) const {
-    std::vector<std::pair<Square, ColoredPiece>> attackers;
-
-    for (int8_t row = 0; row < 8; ++row) {
-        for (int8_t col = 0; col < 8; ++col) {
-            Square from{row, col};
-            ColoredPiece cp = pos->getPiece(from);
-            if (cp == NO_COLORED_PIECE)
-                continue;
-            Move move;
-            move.from = from, move.to = target;
-
-            if (pos->movementValidator.isValidMove(move)) {
-                attackers.emplace_back(from, cp);
-            }
+/**
+ * @returns the square (as a single-bit bitboard) of the cheapest of the
+ * attackers belonging to the color, storing its type in `piece`.
+ */
+Bitboard Engine::getLeastValuableAttacker(Position *pos, Bitboard attackers,
+                                          Color color, Piece &piece) const {
+    for (Piece p : {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING}) {
+        Bitboard candidates = attackers & pos->getPieces(color, p);
+        if (candidates) {
+            piece = p;
+            return candidates & -candidates;
         }
     }
-
-    // Sort by value of attacking piece (a better attacker has smaller value)
-    std::sort(attackers.begin(), attackers.end(),
-              [this](const auto &a, const auto &b) {
-                  int valA = std::abs(getPieceValue(a.second));
-                  int valB = std::abs(getPieceValue(b.second));
-                  return valA < valB;
-              });
-
-    return attackers;
+    return EMPTY_BITBOARD;
 }
 
 bool Engine::isTimeUp() const {
@@ -0,0 +1,54 @@
+#include "input_planes.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHESS_X86_64 1
+#include <immintrin.h>
+#endif
+
+void expandPlanesScalar(const InputPlanes &planes, float *out) {
+    for (const Bitboard plane : planes) {
+        for (int sq = 0; sq < 64; ++sq)
+            *out++ = (plane >> sq) & 1 ? 1.0f : 0.0f;
+    }
+}
+
+#ifdef CHESS_X86_64
+/**
+ * Each byte of a plane is one row: broadcast it to eight lanes, keep the
+ * lane's own bit and turn the lanes where it is set into 1.0f.
+ */
+__attribute__((target("avx2"))) static void
+expandPlanesAvx2(const InputPlanes &planes, float *out) {
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256 ones = _mm256_set1_ps(1.0f);
+    for (const Bitboard plane : planes) {
+        for (int row = 0; row < 8; ++row) {
+            __m256i rowBits = _mm256_set1_epi32((plane >> (row * 8)) & 0xFF);
+            __m256i set =
+                _mm256_cmpeq_epi32(_mm256_and_si256(rowBits, bits), bits);
+            _mm256_storeu_ps(out, _mm256_and_ps(_mm256_castsi256_ps(set), ones));
+            out += 8;
+        }
+    }
+}
+#endif
+
+bool cpuHasAvx2() {
+#ifdef CHESS_X86_64
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void expandPlanes(const InputPlanes &planes, float *out) {
+#ifdef CHESS_X86_64
+    static const bool useAvx2 = cpuHasAvx2();
+    if (useAvx2) {
+        expandPlanesAvx2(planes, out);
+        return;
+    }
+#endif
+    expandPlanesScalar(planes, out);
+}
@@ -1,7 +1,9 @@
 #include "engine.h"
 #include "move_parser.h"
+#include "perft.h"
 #include "position.h"
 #include <iostream>
+#include <sstream>
 #include <string>
 
 int main() {
@@ -28,6 +30,10 @@ int main() {
                   << "          - 'u' to undo move\n"
                   << "          - 'r' to redo move\n"
                   << "          - 'e' to activate engine for current color\n"
+                  << "          - 'perft <depth> [hash MB] [threads]' to count "
+                     "leaves\n"
+                  << "          - 'divide <depth> [hash MB] [threads]' to count "
+                     "per move\n"
                   << "          - 'q' to quit\n"
                   << "Your move: ";
         std::getline(std::cin, moveStr);
@@ -41,6 +47,17 @@ int main() {
             } else if (moveStr.length() == 1 && moveStr[0] == 'r') {
                 position.moveMaker.remakeMove();
                 enginePlay = false;
+            } else if (moveStr.rfind("perft ", 0) == 0 ||
+                       moveStr.rfind("divide ", 0) == 0) {
+                std::istringstream iss(moveStr);
+                std::string command;
+                int depth = 1;
+                size_t hashSizeMb = 0;
+                unsigned threads = 1;
+                iss >> command >> depth >> hashSizeMb >> threads;
+                Perft perft(&position, hashSizeMb, threads);
+                perft.report(depth, command == "divide", std::cout);
+                continue;
             } else if (moveStr.length() == 1 && moveStr[0] == 'e') {
                 activeEngine = true;
                 engineColor = position.getTurn();
@@ -1,6 +1,7 @@
 #include "move_maker.h"
 #include "position.h"
 #include "types.h"
+#include <cassert>
 #include <iostream>
 
 MoveMaker::MoveMaker(Position *position) : position(position){};
@@ -33,7 +34,7 @@ MoveContext MoveMaker::makeLegalMove(const Move &move) {
     moveHistory.push_back(context);
     moveCursor++;
 
-    ColoredPiece movingPiece = position->getPiece(move.from);
+    ColoredPiece movingPiece = position->getPiece(move.from());
     ColoredPiece capturedPiece = context.capturedPiece;
     movePiece(move);
 
@@ -41,35 +42,32 @@ MoveContext MoveMaker::makeLegalMove(const Move &move) {
 
     this->position->changeTurn();
 
-    position->updateZobristHash(move, context);
-
     return context;
 }
 
 MoveContext MoveMaker::getMoveContext(const Move &move) const {
     MoveContext context;
     context.move = move;
-    context.movedPiece = position->getPiece(move.from);
+    context.movedPiece = position->getPiece(move.from());
     context.capturedPiece = this->getCapturedPiece(move);
-    context.previousEnPassant = position->enPassantSquare;
-    context.previousCastleState = position->castleState;
-    context.previousHalfmoveClock = position->halfmoveClock;
-    context.previousFullmoveNumber = position->fullmoveNumber;
-    context.previousTurn = position->turn;
+    context.previousEnPassant = position->getEnPassantSquare();
+    context.previousCastleState = position->state.castleState;
+    context.previousHalfmoveClock = position->state.halfmoveClock;
+    context.previousFullmoveNumber = position->state.fullmoveNumber;
+    context.previousTurn = position->state.turn;
     context.wasEnPassantCapture = this->isEnPassant(move);
     context.wasCastling = this->isCastling(move);
-    context.previousHash = position->zobristHash;
-    context.previousInputTensor = position->inputTensor;
+    context.previousHash = position->state.zobristHash;
 
     return context;
 }
 
 ColoredPiece MoveMaker::getCapturedPiece(const Move &move) const {
-    ColoredPiece capturedPiece = position->getPiece(move.to);
+    ColoredPiece capturedPiece = position->getPiece(move.to());
     if (this->isEnPassant(move)) {
         int colorIndex =
-            (position->getPiece(move.from).color == WHITE) ? 1 : -1;
-        Square toSquare = move.to;
+            (position->getPiece(move.from()).color == WHITE) ? 1 : -1;
+        Square toSquare = move.to();
         capturedPiece =
             position->getPiece(Square(toSquare.row + colorIndex, toSquare.col));
     }
@@ -77,25 +75,25 @@ ColoredPiece MoveMaker::getCapturedPiece(const Move &move) const {
 }
 
 bool MoveMaker::isEnPassant(const Move &move) const {
-    ColoredPiece movingPiece = position->getPiece(move.from);
+    ColoredPiece movingPiece = position->getPiece(move.from());
     if (movingPiece.piece != PAWN)
         return false;
-    return move.to == position->getEnPassantSquare();
+    return move.to() == position->getEnPassantSquare();
 }
 
 bool MoveMaker::isCastling(const Move &move) const {
-    ColoredPiece movingPiece = position->getPiece(move.from);
+    ColoredPiece movingPiece = position->getPiece(move.from());
     if (movingPiece.piece != KING)
         return false;
-    Square fromSquare = move.from;
-    Square toSquare = move.to;
+    Square fromSquare = move.from();
+    Square toSquare = move.to();
     return std::abs(fromSquare.col - toSquare.col) == 2;
 }
 
 MoveContext MoveMaker::movePiece(const Move &move) {
-    updateCastleAfterRookCapture(move);
     MoveContext context = getMoveContext(move);
-    ColoredPiece movingPiece = position->getPiece(move.from);
+    updateCastleAfterRookCapture(move);
+    ColoredPiece movingPiece = position->getPiece(move.from());
 
     ColoredPiece capturedPiece;
 
@@ -111,17 +109,17 @@ MoveContext MoveMaker::movePiece(const Move &move) {
     } else if (movingPiece.piece == ROOK) {
         capturedPiece = moveRook(move);
     } else {
-        capturedPiece = position->getPiece(move.to);
+        capturedPiece = position->getPiece(move.to());
     }
 
-    position->setPiece(move.to, movingPiece);
-    position->setPiece(move.from, NO_COLORED_PIECE);
+    position->setPiece(move.to(), movingPiece);
+    position->setPiece(move.from(), NO_COLORED_PIECE);
 
     return context;
 }
 
 void MoveMaker::updateCastleAfterRookCapture(const Move &move) {
-    Square to = move.to;
+    Square to = move.to();
     if (to.row == 0) {
         if (to.col == 0) {
             int state = position->getCastleState(BLACK) & ~QUEEN_SIDE;
@@ -145,12 +143,12 @@ void MoveMaker::updateCastleAfterRookCapture(const Move &move) {
 }
 
 ColoredPiece MoveMaker::movePawn(const Move &move) {
-    if (move.promotionPiece != NO_COLORED_PIECE) {
+    if (move.isPromotion()) {
         return promotePawn(move);
     }
 
-    Square fromSquare = move.from;
-    Square toSquare = move.to;
+    Square fromSquare = move.from();
+    Square toSquare = move.to();
 
     int colorIndex = (position->getPiece(fromSquare).color == WHITE) ? 1 : -1;
     ColoredPiece capturedPiece = position->getPiece(toSquare);
@@ -173,7 +171,7 @@ ColoredPiece MoveMaker::movePawn(const Move &move) {
 
     colorIndex = (position->getPiece(fromSquare).color == WHITE) ? 0 : 7;
     if (toSquare.row == colorIndex) {
-        position->setPiece(toSquare, move.promotionPiece);
+        position->setPiece(toSquare, move.promotionPiece());
     }
 
     position->setPiece(fromSquare, NO_COLORED_PIECE);
@@ -183,20 +181,21 @@ ColoredPiece MoveMaker::movePawn(const Move &move) {
 }
 
 ColoredPiece MoveMaker::promotePawn(const Move &move) {
-    ColoredPiece promotionPiece = move.promotionPiece;
-    ColoredPiece capturedPiece = position->getPiece(move.to);
-    promotionPiece.color = position->getPiece(move.from).color;
-    position->setPiece(move.to, promotionPiece);
-    position->setPiece(move.from, NO_COLORED_PIECE);
+    ColoredPiece promotionPiece = move.promotionPiece();
+    ColoredPiece capturedPiece = position->getPiece(move.to());
+    promotionPiece.color = position->getPiece(move.from()).color;
+    position->setPiece(move.to(), promotionPiece);
+    position->setPiece(move.from(), NO_COLORED_PIECE);
+    position->setEnPassantSquare(INVALID_SQUARE);
 
     return capturedPiece;
 }
 
 ColoredPiece MoveMaker::moveKing(const Move &move) {
-    ColoredPiece king = position->getPiece(move.from);
+    ColoredPiece king = position->getPiece(move.from());
 
-    Square fromSquare = move.from;
-    Square toSquare = move.to;
+    Square fromSquare = move.from();
+    Square toSquare = move.to();
 
     if (std::abs(fromSquare.col - toSquare.col) == 2) {
         ColoredPiece rook;
@@ -225,10 +224,13 @@ ColoredPiece MoveMaker::moveKing(const Move &move) {
 }
 
 ColoredPiece MoveMaker::moveRook(const Move &move) {
-    position->getPiece(move.from);
-    ColoredPiece rook = position->getPiece(move.from);
+    position->getPiece(move.from());
+    ColoredPiece rook = position->getPiece(move.from());
 
-    int fromCol = move.from.col;
+    int fromCol = move.from().col;
+    int homeRow = (rook.color == WHITE) ? 7 : 0;
+    if (move.from().row != homeRow)
+        return position->getPiece(move.to());
 
     if (fromCol == 7) {
         if (rook.color == WHITE) {
@@ -249,7 +251,7 @@ ColoredPiece MoveMaker::moveRook(const Move &move) {
         }
     }
 
-    return position->getPiece(move.to);
+    return position->getPiece(move.to());
 }
 
 void MoveMaker::unmakeMove() {
@@ -266,12 +268,11 @@ void MoveMaker::unmovePiece(const MoveContext &context) {
     const Move &move = context.move;
 
     ColoredPiece movedPiece = context.movedPiece;
-    position->setPiece(move.from, movedPiece);
-    position->setPiece(move.to, context.capturedPiece);
-    position->zobristHash = context.previousHash;
+    position->setPiece(move.from(), movedPiece);
+    position->setPiece(move.to(), context.capturedPiece);
 
-    Square from = move.from;
-    Square to = move.to;
+    Square from = move.from();
+    Square to = move.to();
 
     if (context.wasEnPassantCapture) {
         bool previousIsWhitesTurn = context.previousTurn == WHITE;
@@ -293,12 +294,14 @@ void MoveMaker::unmovePiece(const MoveContext &context) {
         }
     }
 
-    position->enPassantSquare = context.previousEnPassant;
-    position->castleState = context.previousCastleState;
-    position->turn = context.previousTurn;
-    position->halfmoveClock = context.previousHalfmoveClock;
-    position->fullmoveNumber = context.previousFullmoveNumber;
-    position->inputTensor = context.previousInputTensor;
+    Square enPassant = context.previousEnPassant;
+    position->state.enPassantIndex =
+        enPassant.isValid() ? squareIndex(enPassant) : -1;
+    position->state.castleState = context.previousCastleState;
+    position->state.turn = context.previousTurn;
+    position->state.halfmoveClock = context.previousHalfmoveClock;
+    position->state.fullmoveNumber = context.previousFullmoveNumber;
+    position->state.zobristHash = context.previousHash;
 }
 
 void MoveMaker::remakeMove() {
@@ -310,4 +313,228 @@ void MoveMaker::remakeMove() {
 
     movePiece(context.move);
     this->position->changeTurn();
-}
\ No newline at end of file
+}
+
+void MoveMaker::setMakeMode(SearchMakeMode mode) {
+    assert(undoPly == 0 && "make mode changed during a search");
+    makeMode = mode;
+}
+
+void MoveMaker::doMove(const Move &move) {
+    BoardState &state = position->state;
+    assert(undoPly < MAX_PLY && "search line deeper than the move stack");
+    if (makeMode == COPY_MAKE) {
+        // Allocated on first use, so positions that never search stay small
+        if (stateStack.empty())
+            stateStack.resize(MAX_PLY);
+        stateStack[undoPly++] = state;
+        applyMove(move);
+        return;
+    }
+
+    UndoInfo &undo = undoStack[undoPly++];
+    undo.move = move;
+    undo.movedPiece = state.pieceAt(move.fromIndex()).piece;
+    undo.castleState = state.castleState;
+    undo.enPassantIndex = state.enPassantIndex;
+    undo.halfmoveClock = state.halfmoveClock;
+    undo.zobristHash = state.zobristHash;
+    undo.capturedPiece = applyMove(move);
+}
+
+/**
+ * The hash of the position after a legal move, built from the key deltas
+ * alone, so a child's table entry can be prefetched before the move is
+ * made. Mirrors the hash updates of applyMove.
+ */
+uint64_t MoveMaker::keyAfter(const Move &move) const {
+    const BoardState &state = position->state;
+    int from = move.fromIndex();
+    int to = move.toIndex();
+    ColoredPiece movingPiece = state.pieceAt(from);
+    ColoredPiece capturedPiece = state.pieceAt(to);
+    ColoredPiece placedPiece = movingPiece;
+    uint64_t key = state.zobristHash ^ ZOBRIST.sideToMoveKey;
+
+    if (state.enPassantIndex >= 0)
+        key ^= ZOBRIST.enPassantFileKey[state.enPassantIndex & 7];
+    if (movingPiece.piece == PAWN) {
+        int up = (movingPiece.color == WHITE) ? PAWN_PUSH<WHITE>
+                                              : PAWN_PUSH<BLACK>;
+        if (to == state.enPassantIndex) {
+            key ^= ZOBRIST.pieceKeys[bitboardIndex(state.pieceAt(to - up))]
+                                    [to - up];
+        }
+        if (move.isPromotion())
+            placedPiece =
+                ColoredPiece(movingPiece.color, move.promotionPiece().piece);
+        if (to - from == 2 * up)
+            key ^= ZOBRIST.enPassantFileKey[from & 7];
+    }
+
+    if (capturedPiece != NO_COLORED_PIECE)
+        key ^= ZOBRIST.pieceKeys[bitboardIndex(capturedPiece)][to];
+    key ^= ZOBRIST.pieceKeys[bitboardIndex(movingPiece)][from] ^
+           ZOBRIST.pieceKeys[bitboardIndex(placedPiece)][to];
+
+    if (movingPiece.piece == KING && std::abs(to - from) == 2) {
+        int rookFrom = (to > from) ? to + 1 : to - 2;
+        int rookTo = (to > from) ? to - 1 : to + 1;
+        const uint64_t *rookKeys =
+            ZOBRIST.pieceKeys[bitboardIndex(state.pieceAt(rookFrom))];
+        key ^= rookKeys[rookFrom] ^ rookKeys[rookTo];
+    }
+
+    CastlingState rights = castlingRightsAfter(state.castleState, from, to);
+    if (rights != state.castleState) {
+        key ^= ZOBRIST.castlingRightsKey[position->getCastlingRightsAsIndex(
+                   state.castleState)] ^
+               ZOBRIST.castlingRightsKey[position->getCastlingRightsAsIndex(
+                   rights)];
+    }
+    return key;
+}
+
+ColoredPiece MoveMaker::applyMove(const Move &move) {
+    if (position->state.pieceAt(move.fromIndex()).color == WHITE)
+        return applyMove<WHITE>(move);
+    return applyMove<BLACK>(move);
+}
+
+/**
+ * Plays a legal move of a Us piece on the board state, hash included.
+ * @returns the captured piece.
+ */
+template <Color Us> ColoredPiece MoveMaker::applyMove(const Move &move) {
+    constexpr int up = PAWN_PUSH<Us>;
+    BoardState &state = position->state;
+    int from = move.fromIndex();
+    int to = move.toIndex();
+    ColoredPiece movingPiece = state.pieceAt(from);
+    ColoredPiece capturedPiece = state.pieceAt(to);
+    ColoredPiece placedPiece = movingPiece;
+    Square enPassant = INVALID_SQUARE;
+
+    if (movingPiece.piece == PAWN) {
+        if (to == state.enPassantIndex) {
+            capturedPiece = state.pieceAt(to - up);
+            position->setPiece(indexToSquare(to - up), NO_COLORED_PIECE);
+        }
+        if (move.isPromotion())
+            placedPiece = ColoredPiece(Us, move.promotionPiece().piece);
+        if (to - from == 2 * up)
+            enPassant = indexToSquare(from + up);
+    }
+
+    position->setPiece(indexToSquare(from), NO_COLORED_PIECE);
+    position->setPiece(indexToSquare(to), placedPiece);
+
+    if (movingPiece.piece == KING && std::abs(to - from) == 2) {
+        int rookFrom = (to > from) ? to + 1 : to - 2;
+        int rookTo = (to > from) ? to - 1 : to + 1;
+        position->setPiece(indexToSquare(rookTo), state.pieceAt(rookFrom));
+        position->setPiece(indexToSquare(rookFrom), NO_COLORED_PIECE);
+    }
+
+    updateCastlingRights(from, to);
+    position->setEnPassantSquare(enPassant);
+
+    position->increaseMoveCounts(movingPiece, capturedPiece);
+    position->changeTurn();
+    return capturedPiece;
+}
+
+void MoveMaker::undoMove() {
+    BoardState &state = position->state;
+    if (makeMode == COPY_MAKE) {
+        state = stateStack[--undoPly];
+        return;
+    }
+
+    const UndoInfo &undo = undoStack[--undoPly];
+    if (state.pieceAt(undo.move.toIndex()).color == WHITE)
+        restoreMove<WHITE>(undo);
+    else
+        restoreMove<BLACK>(undo);
+}
+
+/**
+ * Takes back a move of a Us piece: moves the pieces back, then restores
+ * the state saved before it.
+ */
+template <Color Us> void MoveMaker::restoreMove(const UndoInfo &undo) {
+    BoardState &state = position->state;
+    int from = undo.move.fromIndex();
+    int to = undo.move.toIndex();
+    ColoredPiece movedPiece = state.pieceAt(to);
+    movedPiece.piece = undo.movedPiece;
+
+    position->setPiece(indexToSquare(to), NO_COLORED_PIECE);
+    position->setPiece(indexToSquare(from), movedPiece);
+
+    if (undo.capturedPiece != NO_COLORED_PIECE) {
+        int captureSquare = to;
+        if (movedPiece.piece == PAWN && to == undo.enPassantIndex)
+            captureSquare = to - PAWN_PUSH<Us>;
+        position->setPiece(indexToSquare(captureSquare), undo.capturedPiece);
+    }
+
+    if (movedPiece.piece == KING && std::abs(to - from) == 2) {
+        int rookFrom = (to > from) ? to + 1 : to - 2;
+        int rookTo = (to > from) ? to - 1 : to + 1;
+        position->setPiece(indexToSquare(rookFrom), state.pieceAt(rookTo));
+        position->setPiece(indexToSquare(rookTo), NO_COLORED_PIECE);
+    }
+
+    state.turn = (state.turn == WHITE) ? BLACK : WHITE;
+    if (state.turn == BLACK)
+        state.fullmoveNumber--;
+    state.castleState = undo.castleState;
+    state.enPassantIndex = undo.enPassantIndex;
+    state.halfmoveClock = undo.halfmoveClock;
+    state.zobristHash = undo.zobristHash;
+}
+
+/**
+ * A king or rook leaving its home square, or a rook captured on it, loses
+ * the matching castling rights.
+ */
+void MoveMaker::updateCastlingRights(int from, int to) {
+    CastlingState rights = castlingRightsAfter(position->state.castleState,
+                                               from, to);
+    if (rights.white != position->getCastleState(WHITE))
+        position->setCastleState(WHITE, rights.white);
+    if (rights.black != position->getCastleState(BLACK))
+        position->setCastleState(BLACK, rights.black);
+}
+
+/**
+ * @returns the castling rights left once a move between the two squares
+ * has touched a king or rook home square.
+ */
+CastlingState MoveMaker::castlingRightsAfter(CastlingState rights, int from,
+                                             int to) {
+    for (int square : {from, to}) {
+        switch (square) {
+        case 60: // e1
+            rights.white = NO_CASTLING;
+            break;
+        case 63: // h1
+            rights.white &= ~KING_SIDE;
+            break;
+        case 56: // a1
+            rights.white &= ~QUEEN_SIDE;
+            break;
+        case 4: // e8
+            rights.black = NO_CASTLING;
+            break;
+        case 7: // h8
+            rights.black &= ~KING_SIDE;
+            break;
+        case 0: // a8
+            rights.black &= ~QUEEN_SIDE;
+            break;
+        }
+    }
+    return rights;
+}
@@ -6,7 +6,7 @@
 #include <stdexcept>
 #include <vector>
 
-std::vector<Move> legalMoves;
+MoveList legalMoves;
 
 MoveParser::MoveParser(Position *position) : position(position) {}
 
@@ -43,7 +43,7 @@ Move MoveParser::moveStringToMove(const std::string &moveStr) {
  * string representations in Standard Algebraic Notation (SAN).
  */
 std::vector<std::pair<Move, std::string>>
-MoveParser::getMoveSANPairs(std::vector<Move> legalMoves) const {
+MoveParser::getMoveSANPairs(const MoveList &legalMoves) const {
     std::vector<std::pair<Move, std::string>> moveSANPairs;
     for (const Move &move : legalMoves) {
         std::string moveRepresentation = moveToString(move);
@@ -57,18 +57,18 @@ MoveParser::getMoveSANPairs(std::vector<Move> legalMoves) const {
 std::string MoveParser::moveToString(const Move move) const {
     loadLegalMoves();
     std::string moveRepresentation;
-    ColoredPiece cp = position->getPiece(move.from);
+    ColoredPiece cp = position->getPiece(move.from());
     Piece type = cp.piece;
 
-    char fromCol = 'a' + move.from.col;
-    char toCol = 'a' + move.to.col;
-    char toRow = '1' + (7 - move.to.row);
+    char fromCol = 'a' + move.from().col;
+    char toCol = 'a' + move.to().col;
+    char toRow = '1' + (7 - move.to().row);
 
     bool isCapture =
         this->position->moveMaker.getCapturedPiece(move) != NO_COLORED_PIECE;
 
-    if (type == KING && std::abs(move.to.col - move.from.col) == 2) {
-        moveRepresentation = (move.to.col > move.from.col) ? "o-o" : "o-o-o";
+    if (type == KING && std::abs(move.to().col - move.from().col) == 2) {
+        moveRepresentation = (move.to().col > move.from().col) ? "o-o" : "o-o-o";
     } else if (type == PAWN) {
         if (isCapture) {
             moveRepresentation += fromCol;
@@ -77,10 +77,10 @@ std::string MoveParser::moveToString(const Move move) const {
         moveRepresentation += toCol;
         moveRepresentation += toRow;
 
-        if (move.promotionPiece.piece != EMPTY) {
+        if (move.isPromotion()) {
             moveRepresentation += '=';
             moveRepresentation +=
-                std::tolower(move.promotionPiece.toChar());
+                std::tolower(move.promotionPiece().toChar());
         }
     } else {
         moveRepresentation += std::tolower(cp.toChar());
@@ -89,15 +89,15 @@ std::string MoveParser::moveToString(const Move move) const {
         bool needCol = false;
         bool needRow = false;
         for (const Move &otherMove : legalMoves) {
-            bool sameDestination = otherMove.to == move.to;
-            bool differentSource = otherMove.from != move.from;
+            bool sameDestination = otherMove.to() == move.to();
+            bool differentSource = otherMove.from() != move.from();
             if (sameDestination && differentSource) {
-                ColoredPiece otherPiece = position->getPiece(otherMove.from);
+                ColoredPiece otherPiece = position->getPiece(otherMove.from());
                 if (otherPiece == cp) {
                     neeedDisambiguation = true;
-                    if (otherMove.from.row == move.from.row)
+                    if (otherMove.from().row == move.from().row)
                         needCol = true;
-                    else if (otherMove.from.col == move.from.col)
+                    else if (otherMove.from().col == move.from().col)
                         needRow = true;
                 }
             }
@@ -105,11 +105,11 @@ std::string MoveParser::moveToString(const Move move) const {
 
         if (needCol && needRow) {
             moveRepresentation += fromCol;
-            moveRepresentation += '1' + (7 - move.from.row);
+            moveRepresentation += '1' + (7 - move.from().row);
         } else if (needCol) {
             moveRepresentation += fromCol;
         } else if (needRow) {
-            moveRepresentation += '1' + (7 - move.from.row);
+            moveRepresentation += '1' + (7 - move.from().row);
         } else if (neeedDisambiguation) {
             moveRepresentation += fromCol;
         }
@@ -139,6 +139,8 @@ Move MoveParser::uciToMove(const std::string &uci) {
 
     Square from(fromRow, fromCol);
     Square to(toRow, toCol);
+    if (!from.isValid() || !to.isValid())
+        return Move();
 
     ColoredPiece promotion = NO_COLORED_PIECE;
 
@@ -0,0 +1,120 @@
+#include "move_picker.h"
+#include "engine.h"
+#include "position.h"
+#include <utility>
+
+MovePicker::MovePicker(Position *position, const Engine *engine, Move ttMove,
+                       const Move killers[2], const int (*history)[64])
+    : position(position), engine(engine), ttMove(ttMove),
+      killers{killers[0], killers[1]}, history(history) {}
+
+Move MovePicker::next() {
+    switch (stage) {
+    case TT_MOVE:
+        stage = GENERATE_CAPTURES;
+        // A hash collision can hand us a move from another position
+        if (ttMove != Move() && position->movementValidator.isValidMove(ttMove))
+            return ttMove;
+        [[fallthrough]];
+
+    case GENERATE_CAPTURES:
+        moves = position->movementValidator.getLegalCaptures(
+            position->getTurn());
+        scoreCaptures();
+        current = 0;
+        stage = GOOD_CAPTURES;
+        [[fallthrough]];
+
+    case GOOD_CAPTURES:
+        while (current < moves.size()) {
+            Move move = pickBest();
+            if (move == ttMove)
+                continue;
+            // Losing captures wait until the quiet moves are tried
+            if (position->getPiece(move.to()) != NO_COLORED_PIECE &&
+                engine->staticExchangeEval(position, move) < 0) {
+                badCaptures.push_back(move);
+                continue;
+            }
+            return move;
+        }
+        stage = KILLERS;
+        [[fallthrough]];
+
+    case KILLERS:
+        while (killerIndex < 2) {
+            Move killer = killers[killerIndex++];
+            if (killer != Move() && killer != ttMove && isQuiet(killer) &&
+                position->movementValidator.isValidMove(killer))
+                return killer;
+        }
+        stage = GENERATE_QUIETS;
+        [[fallthrough]];
+
+    case GENERATE_QUIETS:
+        moves =
+            position->movementValidator.getLegalQuiets(position->getTurn());
+        scoreQuiets();
+        current = 0;
+        stage = QUIETS;
+        [[fallthrough]];
+
+    case QUIETS:
+        while (current < moves.size()) {
+            Move move = pickBest();
+            if (!isSearchedEarly(move))
+                return move;
+        }
+        current = 0;
+        stage = BAD_CAPTURES;
+        [[fallthrough]];
+
+    case BAD_CAPTURES:
+        if (current < badCaptures.size())
+            return badCaptures[current++];
+        stage = DONE;
+        [[fallthrough]];
+
+    case DONE:
+        break;
+    }
+    return Move();
+}
+
+bool MovePicker::isQuiet(Move move) const {
+    if (move.isPromotion() ||
+        position->getPiece(move.to()) != NO_COLORED_PIECE)
+        return false;
+    // A pawn changing file onto an empty square captures en passant
+    return position->getPiece(move.from()).piece != PAWN ||
+           move.from().col == move.to().col;
+}
+
+void MovePicker::scoreCaptures() {
+    for (size_t i = 0; i < moves.size(); ++i)
+        scores[i] = engine->scoreMove(moves[i], position);
+}
+
+void MovePicker::scoreQuiets() {
+    for (size_t i = 0; i < moves.size(); ++i)
+        scores[i] = history[moves[i].fromIndex()][moves[i].toIndex()];
+}
+
+/**
+ * Selection step: swaps the best scored remaining move to the front of the
+ * remaining ones and returns it, so moves after a cutoff are never sorted.
+ */
+Move MovePicker::pickBest() {
+    size_t best = current;
+    for (size_t i = current + 1; i < moves.size(); ++i) {
+        if (scores[i] > scores[best])
+            best = i;
+    }
+    std::swap(moves[current], moves[best]);
+    std::swap(scores[current], scores[best]);
+    return moves[current++];
+}
+
+bool MovePicker::isSearchedEarly(Move move) const {
+    return move == ttMove || move == killers[0] || move == killers[1];
+}
@@ -1,13 +1,14 @@
 #include "movement_validator.h"
+#include "attacks.h"
 #include "position.h"
 #include "types.h"
 
 MovementValidator::MovementValidator(Position *position) : position(position) {}
 
 bool MovementValidator::isValidMove(const Move &move) const {
-    int fromRow = move.from.row, fromCol = move.from.col;
-    int toRow = move.to.row, toCol = move.to.col;
-    ColoredPiece movingPiece = this->position->getPiece(move.from);
+    int fromRow = move.from().row, fromCol = move.from().col;
+    int toRow = move.to().row, toCol = move.to().col;
+    ColoredPiece movingPiece = this->position->getPiece(move.from());
     ColoredPiece capturedPiece =
         this->position->moveMaker.getCapturedPiece(move);
     if (fromRow < 0 || fromRow >= 8 || fromCol < 0 || fromCol >= 8 ||
@@ -25,28 +26,42 @@ bool MovementValidator::isValidMove(const Move &move) const {
     if (!isValidPieceMovement(movingPiece.piece, move))
         return false;
 
+    if (move.isPromotion() && !isValidPromotion(movingPiece, move))
+        return false;
+
     if (moveLeadsIntoCheck(move))
         return false;
 
     return true;
 }
 
-bool MovementValidator::moveLeadsIntoCheck(Move move) const {
-
-    MoveContext context = position->moveMaker.getMoveContext(move);
+/**
+ * Promotion bits are only valid on a pawn reaching its last row, turning
+ * into a knight, bishop, rook or queen of its own color.
+ */
+bool MovementValidator::isValidPromotion(ColoredPiece movingPiece,
+                                         Move move) const {
+    int promotionRow = (movingPiece.color == WHITE) ? 0 : 7;
+    ColoredPiece promotion = move.promotionPiece();
+    if (movingPiece.piece != PAWN || move.to().row != promotionRow ||
+        promotion.color != movingPiece.color)
+        return false;
+    return promotion.piece == KNIGHT || promotion.piece == BISHOP ||
+           promotion.piece == ROOK || promotion.piece == QUEEN;
+}
 
-    position->moveMaker.movePiece(move);
+bool MovementValidator::moveLeadsIntoCheck(Move move) const {
+    Color color = position->getTurn();
 
-    Color color = context.previousTurn;
+    position->moveMaker.doMove(move);
     bool isChecked = position->scanner.isInCheck(color);
-
-    position->moveMaker.unmovePiece(context);
+    position->moveMaker.undoMove();
 
     return isChecked;
 }
 
 bool MovementValidator::isValidPieceMovement(Piece piece, Move move) const {
-    if (move.from.col == move.to.col && move.from.row == move.to.row)
+    if (move.from().col == move.to().col && move.from().row == move.to().row)
         return false;
     switch (piece) {
     case PAWN:
@@ -67,240 +82,335 @@ bool MovementValidator::isValidPieceMovement(Piece piece, Move move) const {
 }
 
 bool MovementValidator::isValidPawnMovement(Move move) const {
-    int colorIndex;
-    bool isWhite;
-    ColoredPiece cp = this->position->getPiece(move.from);
-
-    if (cp.color == WHITE) {
-        colorIndex = 1;
-        isWhite = true;
-    } else {
-        colorIndex = -1;
-        isWhite = false;
-    }
-
-    int fromCol = move.from.col, fromRow = move.from.row;
-    int toCol = move.to.col, toRow = move.to.row;
-    int promotionRow = (cp.color == WHITE) ? 0 : 7;
+    Color color = this->position->getPiece(move.from()).color;
+    int from = squareIndex(move.from()), to = squareIndex(move.to());
+    int up = (color == WHITE) ? -8 : 8;
+    int promotionRow = (color == WHITE) ? 0 : 7;
+    int startRow = (color == WHITE) ? 6 : 1;
+    Bitboard occupancy = position->getOccupancy();
+    Bitboard toBit = squareBitboard(to);
 
-    if (toRow == promotionRow && move.promotionPiece == NO_COLORED_PIECE)
+    if (move.to().row == promotionRow &&
+        move.promotionPiece() == NO_COLORED_PIECE)
         return false;
 
-    if (fromCol == toCol && toRow == fromRow - colorIndex &&
-        this->position->getPiece(move.to) == NO_COLORED_PIECE)
-        return true;
+    if (to == from + up)
+        return !(occupancy & toBit);
+    if (to == from + 2 * up && move.from().row == startRow)
+        return !(occupancy & (toBit | squareBitboard(from + up)));
 
-    if (fromRow == (isWhite ? 6 : 1) && fromCol == toCol &&
-        toRow == fromRow - (2 * colorIndex) &&
-        this->position->getPiece(move.to) == NO_COLORED_PIECE &&
-        this->position->getPiece(Square(toRow + colorIndex, toCol)) ==
-            NO_COLORED_PIECE) {
-        return true;
-    }
-    if (toCol == fromCol - 1 && toRow == fromRow - colorIndex &&
-        this->position->getPiece(move.to) != NO_COLORED_PIECE)
-        return true;
-    if (toCol == fromCol + 1 && toRow == fromRow - colorIndex &&
-        this->position->getPiece(move.to) != NO_COLORED_PIECE)
-        return true;
-
-    if (move.to == this->position->getEnPassantSquare() &&
-        toCol == fromCol - 1 && toRow == fromRow - colorIndex &&
-        this->position->getPiece(Square(toRow + colorIndex, toCol)) !=
-            NO_COLORED_PIECE)
-        return true;
-    if (move.to == this->position->getEnPassantSquare() &&
-        toCol == fromCol + 1 && toRow == fromRow - colorIndex &&
-        this->position->getPiece(Square(toRow + colorIndex, toCol)) !=
-            NO_COLORED_PIECE)
+    if (!(pawnAttacks(color, from) & toBit))
+        return false;
+    if (occupancy & toBit)
         return true;
-
-    return false;
+    return move.to() == this->position->getEnPassantSquare() &&
+           (occupancy & squareBitboard(to - up));
 }
 
 bool MovementValidator::isValidKnightMovement(Move move) const {
-    return std::abs(move.to.col - move.from.col) *
-               std::abs(move.to.row - move.from.row) ==
-           2;
+    return knightAttacks(squareIndex(move.from())) &
+           squareBitboard(move.to());
 }
 
 bool MovementValidator::isValidBishopMovement(Move move) const {
-    int fromRow = move.from.row, fromCol = move.from.col;
-    int toRow = move.to.row, toCol = move.to.col;
-
-    if (std::abs(fromCol - toCol) != std::abs(fromRow - toRow)) {
-        return false;
-    }
-
-    int dRow = (toRow > fromRow) ? 1 : -1;
-    int dCol = (toCol > fromCol) ? 1 : -1;
-    int steps = std::abs(toRow - fromRow);
+    Bitboard attacks =
+        bishopAttacks(squareIndex(move.from()), position->getOccupancy());
+    return attacks & squareBitboard(move.to());
+}
 
-    for (int i = 1; i < steps; ++i) {
-        int checkRow = fromRow + i * dRow;
-        int checkCol = fromCol + i * dCol;
-        Square checkSquare = Square(checkRow, checkCol);
-        ColoredPiece checkPiece = position->getPiece(checkSquare);
-        if (checkPiece != NO_COLORED_PIECE) {
-            return false;
-        }
-    }
+bool MovementValidator::isValidRookMovement(Move move) const {
+    Bitboard attacks =
+        rookAttacks(squareIndex(move.from()), position->getOccupancy());
+    return attacks & squareBitboard(move.to());
+}
 
-    return true;
+bool MovementValidator::isValidQueenMovement(Move move) const {
+    Bitboard attacks =
+        queenAttacks(squareIndex(move.from()), position->getOccupancy());
+    return attacks & squareBitboard(move.to());
 }
 
-bool MovementValidator::isValidRookMovement(Move move) const {
-    int fromRow = move.from.row, fromCol = move.from.col;
-    int toRow = move.to.row, toCol = move.to.col;
+bool MovementValidator::isValidKingMovement(Move move) const {
+    int from = squareIndex(move.from()), to = squareIndex(move.to());
+    if (kingAttacks(from) & squareBitboard(to))
+        return true;
 
-    if (fromRow != toRow && fromCol != toCol) {
+    bool isCastling = move.from().col == 4 && move.from().row == move.to().row &&
+                      squareDistance(from, to) == 2;
+    if (!isCastling)
         return false;
-    }
 
-    int dRow = (toRow > fromRow) ? 1 : (toRow < fromRow) ? -1 : 0;
-    int dCol = (toCol > fromCol) ? 1 : (toCol < fromCol) ? -1 : 0;
-    int steps = std::abs(toRow - fromRow + toCol - fromCol);
+    Color color = this->position->getPiece(move.from()).color;
+    bool isKingside = to > from;
+    if (!(this->position->getCastleState(color) &
+          (isKingside ? KING_SIDE : QUEEN_SIDE)))
+        return false;
 
-    for (int i = 1; i < steps; ++i) {
-        int checkRow = fromRow + i * dRow;
-        int checkCol = fromCol + i * dCol;
-        Square checkSquare = Square(checkRow, checkCol);
-        ColoredPiece checkPiece = position->getPiece(checkSquare);
-        if (checkPiece != NO_COLORED_PIECE) {
+    // The rook's path must be empty, the king's path (b1/b8 excluded) safe
+    int rookFrom = isKingside ? from + 3 : from - 4;
+    if (betweenSquares(from, rookFrom) & position->getOccupancy())
+        return false;
+
+    Bitboard kingPath =
+        squareBitboard(from) | betweenSquares(from, to) | squareBitboard(to);
+    while (kingPath) {
+        if (this->position->scanner.isSquareInCheck(
+                indexToSquare(popLsb(kingPath)), color))
             return false;
-        }
     }
-
     return true;
 }
 
-bool MovementValidator::isValidQueenMovement(Move move) const {
-    if (isValidRookMovement(move)) {
-        return true;
-    }
-    if (isValidBishopMovement(move)) {
-        return true;
-    }
-    return false;
+/**
+ * @param color the color for which to get legal moves.
+ * @returns a list of all legal moves for the given color.
+ */
+MoveList MovementValidator::getLegalMoves(Color color) {
+    MoveList legalMoves;
+    generateLegalMoves<ALL_MOVES>(color, legalMoves, false);
+    return legalMoves;
 }
 
-bool MovementValidator::isValidKingMovement(Move move) const {
-    int fromRow = move.from.row, fromCol = move.from.col;
-    int toRow = move.to.row, toCol = move.to.col;
-
-    ColoredPiece cp = this->position->getPiece(move.from);
-    Color color = cp.color;
-    bool isCastling =
-        (std::abs(fromCol - toCol) == 2 && fromRow == toRow && fromCol == 4);
-    if (isCastling) {
-        if (this->position->scanner.isSquareInCheck(Square(fromRow, 4),
-                                                    color)) {
-            return false;
-        }
-        bool isKingside = (toCol == 6);
-        bool isQueenside = (toCol == 2);
-        if (isKingside && (this->position->getCastleState(color) & KING_SIDE)) {
-            for (int col = 5; col <= 6; col++) {
-                if (this->position->scanner.isSquareInCheck(
-                        Square(fromRow, col), color)) {
-                    return false;
-                }
-                ColoredPiece p = position->getPiece(Square(toRow, col));
-                if (p != NO_COLORED_PIECE) {
-                    return false;
-                }
-            }
-        } else if (isQueenside &&
-                   (this->position->getCastleState(color) & QUEEN_SIDE)) {
-            for (int col = 2; col < 4; col++) {
-                if (this->position->scanner.isSquareInCheck(
-                        Square(fromRow, col), color)) {
-                    return false;
-                }
-                ColoredPiece p = position->getPiece(Square(toRow, col));
-                if (p != NO_COLORED_PIECE) {
-                    return false;
-                }
-            }
-        } else {
-            return false;
-        }
-        return true;
-    }
-    bool isDiagonalMove = std::abs((fromCol - toCol) * (fromRow - toRow)) == 1;
-    bool isStraightMove =
-        (fromCol == toCol && std::abs(fromRow - toRow) == 1) ||
-        (fromRow == toRow && std::abs(fromCol - toCol) == 1);
-    return isDiagonalMove || isStraightMove;
+MoveList MovementValidator::getLegalCaptures(Color color) const {
+    MoveList captures;
+    generateLegalMoves<CAPTURES>(color, captures, false);
+    return captures;
+}
+
+MoveList MovementValidator::getLegalQuiets(Color color) const {
+    MoveList quiets;
+    generateLegalMoves<QUIETS>(color, quiets, false);
+    return quiets;
 }
 
 /**
- * @param color the color for which to get legal moves.
- * @returns a vector of all legal moves for the given color.
+ * Stops at the first piece with a legal move, so telling checkmate and
+ * stalemate apart from a normal position rarely generates the whole list.
  */
-std::vector<Move> MovementValidator::getLegalMoves(Color color) {
-    std::vector<Move> legalMoves;
-    std::unordered_set<Square> piecesSquares =
-        position->getPiecesSquares(color);
-
-    for (Square from : piecesSquares) {
-        std::vector<Move> pieceMoves;
-        ColoredPiece cp = this->position->getPiece(from);
-        switch (cp.piece) {
-        case PAWN:
-            pieceMoves = getLegalPawnMovements(from, color);
-            break;
+bool MovementValidator::hasAnyLegalMove(Color color) const {
+    MoveList legalMoves;
+    generateLegalMoves<ALL_MOVES>(color, legalMoves, true);
+    return !legalMoves.empty();
+}
+
+template <GenType Type>
+void MovementValidator::generateLegalMoves(Color color, MoveList &legalMoves,
+                                           bool stopAtFirst) const {
+    if (color == WHITE)
+        generateLegalMoves<WHITE, Type>(legalMoves, stopAtFirst);
+    else
+        generateLegalMoves<BLACK, Type>(legalMoves, stopAtFirst);
+}
+
+/**
+ * Checkers and pinned pieces are computed once, then every piece only
+ * generates targets that resolve a check and stay on its pin line, so no
+ * move has to be played to test it. En passant is the exception: removing
+ * two pawns from one rank can expose the king, so it is still tried.
+ * With stopAtFirst, returns as soon as any piece has added a move.
+ * Type restricts the targets to enemy pieces (captures) or empty squares
+ * (quiets); pawns additionally sort promotions into the captures.
+ */
+template <Color Us, GenType Type>
+void MovementValidator::generateLegalMoves(MoveList &legalMoves,
+                                           bool stopAtFirst) const {
+    constexpr Color them = (Us == WHITE) ? BLACK : WHITE;
+    int kingIndex = position->getKingIndex(Us);
+
+    Bitboard targets = ALL_SQUARES;
+    if constexpr (Type == CAPTURES)
+        targets = position->getPieces(them);
+    else if constexpr (Type == QUIETS)
+        targets = ~position->getOccupancy();
+
+    Bitboard checkers = EMPTY_BITBOARD;
+    Bitboard pinned = EMPTY_BITBOARD;
+    if (kingIndex >= 0) {
+        Square kingSquare = indexToSquare(kingIndex);
+        getSafeKingMovements(kingSquare, Us, legalMoves, targets);
+        if constexpr (Type != CAPTURES)
+            getCastlingMovements(kingSquare, Us, legalMoves);
+        if (stopAtFirst && !legalMoves.empty())
+            return;
+        checkers = position->scanner.attackersTo(kingIndex,
+                                                 position->getOccupancy()) &
+                   position->getPieces(them);
+        pinned = getPinnedPieces(kingIndex, Us);
+    }
+
+    // In double check only the king can move
+    if (popCount(checkers) > 1)
+        return;
+
+    // In single check, other pieces must capture the checker or block it
+    Bitboard checkMask = ALL_SQUARES;
+    if (checkers)
+        checkMask = checkers | betweenSquares(kingIndex, lsbIndex(checkers));
+
+    generatePawnMoves<Us, Type>(position->getPieces(Us, PAWN), checkMask,
+                                pinned, kingIndex, legalMoves);
+    if (stopAtFirst && !legalMoves.empty())
+        return;
+
+    Bitboard pieces = position->getPieces(Us) &
+                      ~position->getPieces(Us, PAWN) &
+                      ~position->getPieces(Us, KING);
+    while (pieces) {
+        int fromIndex = popLsb(pieces);
+        Square from = indexToSquare(fromIndex);
+        Bitboard allowed = checkMask & targets;
+        if (pinned & squareBitboard(fromIndex))
+            allowed &= lineThrough(kingIndex, fromIndex);
+
+        switch (position->getPiece(from).piece) {
         case KNIGHT:
-            pieceMoves = getLegalKnightMovements(from, color);
+            getLegalKnightMovements(from, Us, legalMoves, allowed);
             break;
         case BISHOP:
-            pieceMoves = getLegalBishopMovements(from, color);
+            getLegalBishopMovements(from, Us, legalMoves, allowed);
             break;
         case ROOK:
-            pieceMoves = getLegalRookMovements(from, color);
+            getLegalRookMovements(from, Us, legalMoves, allowed);
             break;
         case QUEEN:
-            pieceMoves = getLegalQueenMovements(from, color);
-            break;
-        case KING:
-            pieceMoves = getLegalKingMovements(from, color);
+            getLegalQueenMovements(from, Us, legalMoves, allowed);
             break;
-        default: // NO_PIECE
+        default:
             break;
         }
-        std::erase_if(pieceMoves, [&](const Move &move) {
-            return moveLeadsIntoCheck(move);
-        });
-        legalMoves.insert(legalMoves.end(), pieceMoves.begin(),
-                          pieceMoves.end());
+        if (stopAtFirst && !legalMoves.empty())
+            return;
     }
+}
 
-    return legalMoves;
+namespace {
+
+/**
+ * Adds a pawn move for every target, the origin being `delta` squares
+ * behind it. Pinned pawns keep only targets on their pin line.
+ */
+template <Color Us, int delta>
+void addPawnMoves(Bitboard targets, Bitboard pinned, int kingIndex,
+                  MoveList &moves) {
+    constexpr Bitboard promotionRow = rowBitboard(PROMOTION_ROW<Us>);
+    while (targets) {
+        int to = popLsb(targets);
+        int from = to - delta;
+        if ((pinned & squareBitboard(from)) &&
+            !(lineThrough(kingIndex, from) & squareBitboard(to)))
+            continue;
+
+        if (promotionRow & squareBitboard(to)) {
+            for (Piece p : {QUEEN, ROOK, BISHOP, KNIGHT})
+                moves.push_back(Move(indexToSquare(from), indexToSquare(to),
+                                     ColoredPiece(Us, p)));
+        } else {
+            moves.push_back(Move(indexToSquare(from), indexToSquare(to)));
+        }
+    }
 }
 
-std::vector<Move> MovementValidator::getLegalMovements(Square from,
-                                                           Color color) const {
+} // namespace
+
+/**
+ * Generates the moves of a whole set of pawns at once, shifting the set
+ * by the color's constant push and capture offsets.
+ */
+template <Color Us, GenType Type>
+void MovementValidator::generatePawnMoves(Bitboard pawns, Bitboard allowed,
+                                          Bitboard pinned, int kingIndex,
+                                          MoveList &moves) const {
+    constexpr Color them = (Us == WHITE) ? BLACK : WHITE;
+    constexpr int up = PAWN_PUSH<Us>;
+    constexpr Bitboard doublePushRow =
+        rowBitboard(PAWN_START_ROW<Us> + up / 8);
+
+    Bitboard empty = ~position->getOccupancy();
+    Bitboard enemies = position->getPieces(them);
+
+    constexpr Bitboard promotionRow = rowBitboard(PROMOTION_ROW<Us>);
+    Bitboard singles = shift<up>(pawns) & empty;
+
+    if constexpr (Type != CAPTURES) {
+        // The double step may block a check even when the single step can't
+        Bitboard doubles = shift<up>(singles & doublePushRow) & empty;
+        Bitboard pushes = singles;
+        if constexpr (Type == QUIETS)
+            pushes &= ~promotionRow;
+        addPawnMoves<Us, up>(pushes & allowed, pinned, kingIndex, moves);
+        addPawnMoves<Us, 2 * up>(doubles & allowed, pinned, kingIndex, moves);
+    }
+    if constexpr (Type == QUIETS)
+        return;
+    if constexpr (Type == CAPTURES)
+        addPawnMoves<Us, up>(singles & promotionRow & allowed, pinned,
+                             kingIndex, moves);
+
+    Bitboard leftCaptures = shift<up - 1>(pawns & ~FILE_A) & enemies;
+    Bitboard rightCaptures = shift<up + 1>(pawns & ~FILE_H) & enemies;
+    addPawnMoves<Us, up - 1>(leftCaptures & allowed, pinned, kingIndex,
+                             moves);
+    addPawnMoves<Us, up + 1>(rightCaptures & allowed, pinned, kingIndex,
+                             moves);
+
+    // Not filtered by the mask: en passant is played out to test it instead
+    Square ep = position->getEnPassantSquare();
+    if (ep.isValid()) {
+        Bitboard capturers = pawns & pawnAttacks(them, squareIndex(ep));
+        while (capturers) {
+            Move move(indexToSquare(popLsb(capturers)), ep);
+            if (!moveLeadsIntoCheck(move))
+                moves.push_back(move);
+        }
+    }
+}
+
+/**
+ * @returns the pieces of the given color that are the only blocker between
+ * their king and an enemy slider.
+ */
+Bitboard MovementValidator::getPinnedPieces(int kingIndex, Color color) const {
+    Color opponent = (color == WHITE) ? BLACK : WHITE;
+    Bitboard queens = position->getPieces(opponent, QUEEN);
+    Bitboard snipers =
+        (rookAttacks(kingIndex, EMPTY_BITBOARD) &
+         (position->getPieces(opponent, ROOK) | queens)) |
+        (bishopAttacks(kingIndex, EMPTY_BITBOARD) &
+         (position->getPieces(opponent, BISHOP) | queens));
+
+    Bitboard occupancy = position->getOccupancy();
+    Bitboard pinned = EMPTY_BITBOARD;
+    while (snipers) {
+        Bitboard blockers =
+            betweenSquares(kingIndex, popLsb(snipers)) & occupancy;
+        if (popCount(blockers) == 1)
+            pinned |= blockers & position->getPieces(color);
+    }
+    return pinned;
+}
+
+MoveList MovementValidator::getLegalMovements(Square from, Color color) const {
     ColoredPiece cp = position->getPiece(from);
-    std::vector<Move> moves;
+    MoveList moves;
 
     switch (cp.piece) {
         case PAWN:
-        moves = getLegalPawnMovements(from,color);
+        getLegalPawnMovements(from, color, moves);
         break;
         case KNIGHT:
-        moves = getLegalKnightMovements(from,color);
+        getLegalKnightMovements(from, color, moves);
         break;
         case BISHOP:
-        moves = getLegalBishopMovements(from,color);
+        getLegalBishopMovements(from, color, moves);
         break;
         case ROOK:
-        moves = getLegalRookMovements(from,color);
+        getLegalRookMovements(from, color, moves);
         break;
         case QUEEN:
-        moves = getLegalQueenMovements(from,color);
+        getLegalQueenMovements(from, color, moves);
         break;
         case KING:
-        moves = getLegalKingMovements(from,color);
+        getLegalKingMovements(from, color, moves);
         break;
         default:
         break;
@@ -309,180 +419,91 @@ std::vector<Move> MovementValidator::getLegalMovements(Square from,
     return moves;
 }
 
-std::vector<Move> MovementValidator::getLegalPawnMovements(Square from,
-                                                           Color color) const {
-    std::vector<Move> pawnMoves;
-
-    int direction = (color == WHITE) ? -1 : 1;
-    int startRow = (color == WHITE) ? 6 : 1;
-    int promotionRow = (color == WHITE) ? 0 : 7;
-
-    Square oneStep(from.row + direction, from.col);
-    Square twoStep(from.row + 2 * direction, from.col);
-
-    if (oneStep.isValid() && position->getPiece(oneStep) == NO_COLORED_PIECE) {
-        if (oneStep.row == promotionRow) {
-            for (Piece p : {QUEEN, ROOK, BISHOP, KNIGHT}) {
-                ColoredPiece cp(color, p);
-                pawnMoves.push_back(Move(from, oneStep, cp));
-            }
-        } else {
-            pawnMoves.push_back(Move(from, oneStep));
-        }
-
-        if (from.row == startRow &&
-            position->getPiece(twoStep) == NO_COLORED_PIECE) {
-            pawnMoves.push_back(Move(from, twoStep));
-        }
-    }
-
-    for (int dc : {-1, 1}) {
-        Square diag(from.row + direction, from.col + dc);
-        if (diag.isValid()) {
-            ColoredPiece target = position->getPiece(diag);
-            if (target != NO_COLORED_PIECE && target.color != color) {
-                if (diag.row == promotionRow) {
-                    for (Piece p : {QUEEN, ROOK, BISHOP, KNIGHT}) {
-                        ColoredPiece cp(color, p);
-                        pawnMoves.push_back(Move(from, diag, cp));
-                    }
-                } else {
-                    pawnMoves.push_back(Move(from, diag));
-                }
-            }
-        }
-    }
-
-    Square ep = position->getEnPassantSquare();
-    if (ep.isValid() && ep.row == from.row + direction &&
-        std::abs(ep.col - from.col) == 1) {
-        pawnMoves.push_back(Move(from, ep));
-    }
-
-    return pawnMoves;
+void MovementValidator::getLegalPawnMovements(Square from, Color color,
+                                              MoveList &moves,
+                                              Bitboard allowed) const {
+    if (color == WHITE)
+        generatePawnMoves<WHITE>(squareBitboard(from), allowed,
+                                 EMPTY_BITBOARD, 0, moves);
+    else
+        generatePawnMoves<BLACK>(squareBitboard(from), allowed,
+                                 EMPTY_BITBOARD, 0, moves);
 }
 
-std::vector<Move>
-MovementValidator::getLegalKnightMovements(Square from, Color color) const {
-    std::vector<Move> knightMoves;
-    std::vector<Square> toSquares;
-    int fromRow = from.row, fromCol = from.col;
-    toSquares.push_back(Square(fromRow + 2, fromCol + 1));
-    toSquares.push_back(Square(fromRow + 2, fromCol - 1));
-    toSquares.push_back(Square(fromRow + 1, fromCol + 2));
-    toSquares.push_back(Square(fromRow + 1, fromCol - 2));
-    toSquares.push_back(Square(fromRow - 1, fromCol + 2));
-    toSquares.push_back(Square(fromRow - 1, fromCol - 2));
-    toSquares.push_back(Square(fromRow - 2, fromCol + 1));
-    toSquares.push_back(Square(fromRow - 2, fromCol - 1));
-
-    for (Square to : toSquares) {
-        bool isValidSquare =
-            (to.col < 8 && to.col > -1 && to.row < 8 && to.row > -1);
-        bool isNotFriend = position->getPiece(to).color != color;
-        if (isValidSquare && isNotFriend) {
-            knightMoves.push_back(Move(from, to));
-        }
-    }
-    return knightMoves;
+void MovementValidator::getLegalKnightMovements(Square from, Color color,
+                                                MoveList &moves,
+                                                Bitboard allowed) const {
+    Bitboard targets = knightAttacks(squareIndex(from)) &
+                       ~position->getPieces(color) & allowed;
+    getMovesToTargets(from, targets, moves);
 }
 
-std::vector<Move>
-MovementValidator::getLegalBishopMovements(Square from, Color color) const {
-    std::vector<Move> bishopMoves;
-    static const std::vector<std::pair<int, int>> directions = {
-        {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-
-    for (auto [dr, dc] : directions) {
-        int r = from.row + dr, c = from.col + dc;
-        while (r >= 0 && r < 8 && c >= 0 && c < 8) {
-            Square to(r, c);
-            ColoredPiece cp = position->getPiece(to);
-            if (cp == NO_COLORED_PIECE) {
-                bishopMoves.push_back(Move(from, to));
-            } else {
-                if (cp.color != color)
-                    bishopMoves.push_back(Move(from, to));
-                break;
-            }
-            r += dr;
-            c += dc;
-        }
-    }
-
-    return bishopMoves;
+void MovementValidator::getLegalBishopMovements(Square from, Color color,
+                                                MoveList &moves,
+                                                Bitboard allowed) const {
+    Bitboard targets =
+        bishopAttacks(squareIndex(from), position->getOccupancy()) &
+        ~position->getPieces(color) & allowed;
+    getMovesToTargets(from, targets, moves);
 }
 
-std::vector<Move> MovementValidator::getLegalRookMovements(Square from,
-                                                           Color color) const {
-    std::vector<Move> rookMoves;
-    static const std::vector<std::pair<int, int>> directions = {
-        {1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-
-    for (auto [dr, dc] : directions) {
-        int r = from.row + dr, c = from.col + dc;
-        while (r >= 0 && r < 8 && c >= 0 && c < 8) {
-            Square to(r, c);
-            ColoredPiece cp = position->getPiece(to);
-            if (cp == NO_COLORED_PIECE) {
-                rookMoves.push_back(Move(from, to));
-            } else {
-                if (cp.color != color)
-                    rookMoves.push_back(Move(from, to));
-                break;
-            }
-            r += dr;
-            c += dc;
-        }
-    }
+void MovementValidator::getLegalRookMovements(Square from, Color color,
+                                              MoveList &moves,
+                                              Bitboard allowed) const {
+    Bitboard targets =
+        rookAttacks(squareIndex(from), position->getOccupancy()) &
+        ~position->getPieces(color) & allowed;
+    getMovesToTargets(from, targets, moves);
+}
 
-    return rookMoves;
+void MovementValidator::getLegalQueenMovements(Square from, Color color,
+                                               MoveList &moves,
+                                               Bitboard allowed) const {
+    Bitboard targets =
+        queenAttacks(squareIndex(from), position->getOccupancy()) &
+        ~position->getPieces(color) & allowed;
+    getMovesToTargets(from, targets, moves);
 }
 
-std::vector<Move> MovementValidator::getLegalQueenMovements(Square from,
-                                                            Color color) const {
-    std::vector<Move> queenMoves;
-
-    static const std::vector<std::pair<int, int>> directions = {
-        {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-
-    for (auto [dr, dc] : directions) {
-        int r = from.row + dr, c = from.col + dc;
-        while (r >= 0 && r < 8 && c >= 0 && c < 8) {
-            Square to(r, c);
-            ColoredPiece cp = position->getPiece(to);
-            if (cp == NO_COLORED_PIECE) {
-                queenMoves.push_back(Move(from, to));
-            } else {
-                if (cp.color != color)
-                    queenMoves.push_back(Move(from, to));
-                break;
-            }
-            r += dr;
-            c += dc;
-        }
+void MovementValidator::getMovesToTargets(Square from, Bitboard targets,
+                                          MoveList &moves) const {
+    while (targets) {
+        moves.push_back(Move(from, indexToSquare(popLsb(targets))));
     }
+}
 
-    return queenMoves;
+void MovementValidator::getLegalKingMovements(Square from, Color color,
+                                              MoveList &moves) const {
+    Bitboard targets = kingAttacks(squareIndex(from)) &
+                       ~position->getPieces(color);
+    getMovesToTargets(from, targets, moves);
+    getCastlingMovements(from, color, moves);
 }
 
-std::vector<Move> MovementValidator::getLegalKingMovements(Square from,
-                                                           Color color) const {
-    std::vector<Move> kingMoves;
-    static const std::vector<std::pair<int, int>> deltas = {
-        {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
-
-    for (auto [dr, dc] : deltas) {
-        int r = from.row + dr, c = from.col + dc;
-        if (r >= 0 && r < 8 && c >= 0 && c < 8) {
-            Square to(r, c);
-            ColoredPiece cp = position->getPiece(to);
-            if (cp == NO_COLORED_PIECE || cp.color != color) {
-                kingMoves.push_back(Move(from, to));
-            }
+/**
+ * King steps onto squares no enemy piece attacks. The king is lifted off the
+ * board first so a slider checking it also covers the square behind it.
+ */
+void MovementValidator::getSafeKingMovements(Square from, Color color,
+                                             MoveList &moves,
+                                             Bitboard allowed) const {
+    Color opponent = (color == WHITE) ? BLACK : WHITE;
+    int fromIndex = squareIndex(from);
+    Bitboard occupancy = position->getOccupancy() & ~squareBitboard(fromIndex);
+    Bitboard targets =
+        kingAttacks(fromIndex) & ~position->getPieces(color) & allowed;
+
+    while (targets) {
+        int to = popLsb(targets);
+        Bitboard attackers = position->scanner.attackersTo(to, occupancy);
+        if (!(attackers & position->getPieces(opponent))) {
+            moves.push_back(Move(from, indexToSquare(to)));
         }
     }
+}
 
+void MovementValidator::getCastlingMovements(Square from, Color color,
+                                             MoveList &moves) const {
     int fromRowCastling = (color == WHITE) ? 7 : 0;
     Square fromCastling(fromRowCastling, 4);
     if (from == fromCastling) {
@@ -490,9 +511,8 @@ std::vector<Move> MovementValidator::getLegalKingMovements(Square from,
              {Square(fromRowCastling, 2), Square(fromRowCastling, 6)}) {
             Move move(from, to);
             if (isValidKingMovement(move)) {
-                kingMoves.push_back(move);
+                moves.push_back(move);
             }
         }
     }
-    return kingMoves;
-}
\ No newline at end of file
+}
@@ -0,0 +1,167 @@
+#include "perft.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <thread>
+
+Perft::Perft(Position *position, size_t hashSizeMb, unsigned threads)
+    : position(position) {
+    setHashSize(hashSizeMb);
+    setThreads(threads);
+}
+
+/**
+ * Sizes the table to the largest power of two of entries that fits, so a
+ * slot is found by masking the hash. 0 disables hashing.
+ */
+void Perft::setHashSize(size_t hashSizeMb) {
+    this->hashSizeMb = hashSizeMb;
+    size_t entries = hashSizeMb * 1024 * 1024 / sizeof(HashEntry);
+    table.assign(entries ? std::bit_floor(entries) : 0, HashEntry{0, 0});
+}
+
+void Perft::setThreads(unsigned threads) {
+    this->threads =
+        threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+uint64_t Perft::perft(int depth) {
+    if (depth <= 0)
+        return 1;
+    if (threads > 1 && depth > 1) {
+        uint64_t nodes = 0;
+        for (const auto &[move, moveNodes] : parallelDivide(depth))
+            nodes += moveNodes;
+        return nodes;
+    }
+    return count(depth);
+}
+
+std::vector<std::pair<Move, uint64_t>> Perft::divide(int depth) {
+    if (threads > 1 && depth > 1)
+        return parallelDivide(depth);
+
+    std::vector<std::pair<Move, uint64_t>> results;
+    MoveList moves =
+        position->movementValidator.getLegalMoves(position->getTurn());
+    for (const Move &move : moves) {
+        position->moveMaker.doMove(move);
+        results.emplace_back(move, perft(depth - 1));
+        position->moveMaker.undoMove();
+    }
+    return results;
+}
+
+uint64_t Perft::report(int depth, bool perMove, std::ostream &out) {
+    auto start = std::chrono::steady_clock::now();
+
+    uint64_t nodes = 0;
+    if (perMove) {
+        for (const auto &[move, moveNodes] : divide(depth)) {
+            out << move.toUCI() << ": " << moveNodes << "\n";
+            nodes += moveNodes;
+        }
+        out << "\n";
+    } else {
+        nodes = perft(depth);
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    uint64_t nps = elapsed ? nodes * 1000000 / elapsed : 0;
+
+    out << "Nodes searched: " << nodes << "\n";
+    out << "Time: " << elapsed / 1000 << " ms\n";
+    out << "NPS: " << nps << "\n";
+    return nodes;
+}
+
+uint64_t Perft::count(int depth) {
+    HashEntry *entry = nullptr;
+    if (depth > 1 && !table.empty()) {
+        entry = &table[position->getZobristHash() & (table.size() - 1)];
+        if (entry->key == position->getZobristHash() &&
+            (entry->data & 0xFF) == uint64_t(depth))
+            return entry->data >> 8;
+    }
+
+    MoveList moves =
+        position->movementValidator.getLegalMoves(position->getTurn());
+    if (depth == 1)
+        return moves.size();
+
+    uint64_t nodes = 0;
+    for (const Move &move : moves) {
+        position->moveMaker.doMove(move);
+        nodes += count(depth - 1);
+        position->moveMaker.undoMove();
+    }
+
+    if (entry)
+        *entry = HashEntry{position->getZobristHash(), (nodes << 8) | depth};
+    return nodes;
+}
+
+/**
+ * Splits the tree into one task per root move, or per root and reply move
+ * from depth 3 on so there are enough tasks to keep every worker busy.
+ * Workers pull the next task from a shared counter until none are left.
+ */
+std::vector<std::pair<Move, uint64_t>> Perft::parallelDivide(int depth) {
+    struct Task {
+        size_t root;
+        Move reply; // Null move when the task is the whole root subtree
+    };
+
+    MoveList rootMoves =
+        position->movementValidator.getLegalMoves(position->getTurn());
+    std::vector<Task> tasks;
+    for (size_t i = 0; i < rootMoves.size(); ++i) {
+        if (depth < 3) {
+            tasks.push_back({i, Move()});
+            continue;
+        }
+        position->moveMaker.doMove(rootMoves[i]);
+        for (const Move &reply :
+             position->movementValidator.getLegalMoves(position->getTurn()))
+            tasks.push_back({i, reply});
+        position->moveMaker.undoMove();
+    }
+
+    std::vector<std::atomic<uint64_t>> rootNodes(rootMoves.size());
+    std::atomic<size_t> nextTask = 0;
+    unsigned workerCount =
+        static_cast<unsigned>(std::min<size_t>(threads, tasks.size()));
+
+    auto work = [&]() {
+        Position workerPosition(*position);
+        Perft worker(&workerPosition, hashSizeMb / std::max(1u, workerCount));
+        for (size_t t = nextTask++; t < tasks.size(); t = nextTask++) {
+            const Task &task = tasks[t];
+            workerPosition.moveMaker.doMove(rootMoves[task.root]);
+            uint64_t nodes;
+            if (task.reply == Move()) {
+                nodes = worker.perft(depth - 1);
+            } else {
+                workerPosition.moveMaker.doMove(task.reply);
+                nodes = worker.perft(depth - 2);
+                workerPosition.moveMaker.undoMove();
+            }
+            workerPosition.moveMaker.undoMove();
+            rootNodes[task.root] += nodes;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers.emplace_back(work);
+    for (std::thread &worker : workers)
+        worker.join();
+
+    std::vector<std::pair<Move, uint64_t>> results;
+    for (size_t i = 0; i < rootMoves.size(); ++i)
+        results.emplace_back(rootMoves[i], rootNodes[i].load());
+    return results;
+}
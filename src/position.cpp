@@ -11,18 +11,17 @@ const std::string startFEN =
 Position::Position()
     : scanner(this), movementValidator(this), moveMaker(this),
       moveParser(this) {
-    for (int row = 0; row < 8; ++row)
-        for (int col = 0; col < 8; ++col)
-            board[row][col] = NO_COLORED_PIECE;
     loadFEN(startFEN);
 }
 
+/**
+ * Copies the board state and the search make mode, without going through
+ * FEN. The move history is not copied: the copy starts a fresh game from p.
+ */
 Position::Position(const Position &p)
     : scanner(this), movementValidator(this), moveMaker(this),
-      moveParser(this) {
-
-    std::string fen = p.getFEN();
-    this->loadFEN(fen);
+      moveParser(this), state(p.state) {
+    moveMaker.setMakeMode(p.moveMaker.getMakeMode());
 }
 
 /**
@@ -31,11 +30,7 @@ Position::Position(const Position &p)
  * <state> <color> <castling rights> <enPassant square> <halfmove> <fullmove>
  */
 void Position::loadFEN(const std::string &fen) {
-    for (int r = 0; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            board[r][c] = NO_COLORED_PIECE;
-        }
-    }
+    clearBoard();
     std::istringstream iss(fen);
     std::string boardPart, activeColor, castling, enPassant;
     int halfmoveClock, fullmoveNumber;
@@ -51,13 +46,14 @@ void Position::loadFEN(const std::string &fen) {
         } else if (std::isdigit(c)) {
             col += c - '0';
         } else {
-            board[row][col] = charToColoredPiece(c);
+            setPiece(Square(row, col), charToColoredPiece(c));
             ++col;
         }
     }
 
-    turn = (activeColor == "w") ? WHITE : BLACK;
+    state.turn = (activeColor == "w") ? WHITE : BLACK;
 
+    CastlingState &castleState = state.castleState;
     castleState.white = 0;
     castleState.black = 0;
     for (char c : castling) {
@@ -85,13 +81,11 @@ void Position::loadFEN(const std::string &fen) {
         this->setEnPassantSquare(Square(8 - (rank - '0'), file - 'a'));
     }
 
-    this->halfmoveClock = halfmoveClock;
-    this->fullmoveNumber = fullmoveNumber;
+    state.halfmoveClock = halfmoveClock;
+    state.fullmoveNumber = fullmoveNumber;
     this->moveMaker.clearMoveHistory();
 
     initZobristHash();
-    loadPiecesSquares();
-    initInputTensor();
 }
 
 std::string Position::getFEN() const {
@@ -99,14 +93,15 @@ std::string Position::getFEN() const {
     for (int row = 0; row < 8; ++row) {
         int emptyCount = 0;
         for (int col = 0; col < 8; ++col) {
-            if (board[row][col] == NO_COLORED_PIECE) {
+            ColoredPiece cp = getPiece(Square(row, col));
+            if (cp == NO_COLORED_PIECE) {
                 emptyCount++;
             } else {
                 if (emptyCount > 0) {
                     oss << emptyCount;
                     emptyCount = 0;
                 }
-                oss << board[row][col].toChar();
+                oss << cp.toChar();
             }
         }
         if (emptyCount > 0) {
@@ -117,7 +112,8 @@ std::string Position::getFEN() const {
         }
     }
 
-    bool isWhitesTurn = (turn == WHITE);
+    const CastlingState &castleState = state.castleState;
+    bool isWhitesTurn = (state.turn == WHITE);
 
     oss << ' ' << (isWhitesTurn ? 'w' : 'b') << ' ';
     if (castleState.white & KING_SIDE)
@@ -131,7 +127,8 @@ std::string Position::getFEN() const {
     if (!(castleState.white | castleState.black))
         oss << '-';
 
-    if (enPassantSquare.row == -1 && enPassantSquare.col == -1) {
+    Square enPassantSquare = getEnPassantSquare();
+    if (!enPassantSquare.isValid()) {
         oss << " -";
     } else {
         char file = 'a' + enPassantSquare.col;
@@ -139,25 +136,15 @@ std::string Position::getFEN() const {
         oss << ' ' << file << rank;
     }
 
-    oss << " " << halfmoveClock << " " << fullmoveNumber;
+    oss << " " << state.halfmoveClock << " " << state.fullmoveNumber;
 
     return oss.str();
 }
 
-void Position::loadPiecesSquares() {
-    piecesSquares.white.clear();
-    piecesSquares.black.clear();
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            Square s(row, col);
-            ColoredPiece cp = getPiece(s);
-            if (cp.color == WHITE) {
-                piecesSquares.white.insert(s);
-            } else if (cp.color == BLACK) {
-                piecesSquares.black.insert(s);
-            }
-        }
-    }
+void Position::clearBoard() {
+    // Value-initialized: empty bitboards, mailbox and hash
+    state = BoardState();
+    state.enPassantIndex = -1;
 }
 
 void Position::printBoard() const {
@@ -166,7 +153,7 @@ void Position::printBoard() const {
     for (int row = 0; row < 8; ++row) {
         std::cout << 8 - row << "| ";
         for (int col = 0; col < 8; ++col) {
-            std::cout << board[row][col].toChar() << " ";
+            std::cout << getPiece(Square(row, col)).toChar() << " ";
         }
         std::cout << "|" << 8 - row << "\n";
     }
@@ -174,139 +161,97 @@ void Position::printBoard() const {
     std::cout << "   a b c d e f g h\n";
 }
 
-ColoredPiece Position::getPiece(Square square) const {
-    return board[square.row][square.col];
-}
-
 void Position::setPiece(Square square, ColoredPiece cp) {
-    board[square.row][square.col] = cp;
-    if (cp.color == NONE) {
-        removePieceSquare(square, BLACK);
-        removePieceSquare(square, WHITE);
-        clearPiecePlanes(this->inputTensor, square.row, square.col);
-        return;
+    int index = squareIndex(square);
+    Bitboard bit = squareBitboard(index);
+
+    ColoredPiece previous = state.pieceAt(index);
+    if (previous != NO_COLORED_PIECE) {
+        state.pieceBitboards[bitboardIndex(previous)] &= ~bit;
+        state.colorBitboards[colorIndex(previous.color)] &= ~bit;
+        state.zobristHash ^= ZOBRIST.pieceKeys[bitboardIndex(previous)][index];
     }
-    if (cp.color == WHITE) {
-        removePieceSquare(square, BLACK);
-    } else if (cp.color == BLACK) {
-        removePieceSquare(square, WHITE);
+
+    if (cp.color == NONE || cp.piece == EMPTY) {
+        state.setMailbox(index, NO_COLORED_PIECE);
+        return;
     }
-    addPieceSquare(square, cp.color);
-    setPiecePlane(this->inputTensor, cp, square.row, square.col);
+    state.setMailbox(index, cp);
+    state.pieceBitboards[bitboardIndex(cp)] |= bit;
+    state.colorBitboards[colorIndex(cp.color)] |= bit;
+    state.zobristHash ^= ZOBRIST.pieceKeys[bitboardIndex(cp)][index];
 }
 
 bool Position::getIsGameOver() const {
-    Color color = getTurn();
-
-    return this->scanner.isInCheckmate(color) ||
-           this->scanner.isInStalemate(color);
+    // Checkmate and stalemate are exactly the positions without a legal move
+    return !this->movementValidator.hasAnyLegalMove(getTurn());
 }
 
 void Position::changeTurn() {
-    Color turnToSet = (this->turn == WHITE) ? BLACK : WHITE;
-    this->turn = turnToSet;
-    if (this->turn == WHITE) {
-        fillPlane(this->inputTensor, 12, 1.0f);
-    } else {
-        fillPlane(this->inputTensor, 12, 0.0f);
-    }
+    Color turnToSet = (state.turn == WHITE) ? BLACK : WHITE;
+    state.turn = turnToSet;
+    state.zobristHash ^= ZOBRIST.sideToMoveKey;
 }
 
 /**
  * Idempotent. Only called by loadFen(fen) to initialize the Zobrist hash.
+ * From then on setPiece, changeTurn, setCastleState and setEnPassantSquare
+ * keep it up to date, so any sequence of board edits hashes the same as
+ * loading the resulting position.
  */
 void Position::initZobristHash() {
+    uint64_t &zobristHash = state.zobristHash;
     zobristHash = 0;
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            ColoredPiece cp = board[row][col];
-            int index = pieceIndex(cp);
-            if (index != -1) {
-                int sq = row * 8 + col;
-                zobristHash ^= zobrist.pieceKeys[index][sq];
-            }
+    for (int sq = 0; sq < 64; ++sq) {
+        ColoredPiece cp = state.pieceAt(sq);
+        if (cp != NO_COLORED_PIECE) {
+            zobristHash ^= ZOBRIST.pieceKeys[bitboardIndex(cp)][sq];
         }
     }
 
-    if (turn == WHITE)
-        zobristHash ^= zobrist.sideToMoveKey;
+    if (state.turn == WHITE)
+        zobristHash ^= ZOBRIST.sideToMoveKey;
 
     zobristHash ^=
-        zobrist.castlingRightsKey[getCastlingRightsAsIndex(castleState)];
+        ZOBRIST.castlingRightsKey[getCastlingRightsAsIndex(state.castleState)];
 
-    if (enPassantSquare != INVALID_SQUARE)
-        zobristHash ^= zobrist.enPassantFileKey[enPassantSquare.col];
+    if (state.enPassantIndex >= 0)
+        zobristHash ^= ZOBRIST.enPassantFileKey[state.enPassantIndex & 7];
 }
 
-void Position::updateZobristHash(const Move &move, MoveContext context) {
-    int fromSq = move.from.row * 8 + move.from.col;
-    int toSq = move.to.row * 8 + move.to.col;
-
-    ColoredPiece moving = board[move.from.row][move.from.col];
-    ColoredPiece captured = board[move.to.row][move.to.col];
-
-    int movingIdx = pieceIndex(moving);
-    int capturedIdx = pieceIndex(captured);
-
-    zobristHash ^= zobrist.pieceKeys[movingIdx][fromSq];
-    zobristHash ^= zobrist.pieceKeys[movingIdx][toSq];
-
-    if (capturedIdx != -1)
-        zobristHash ^= zobrist.pieceKeys[capturedIdx][toSq];
-
-    if (move.promotionPiece != NO_COLORED_PIECE) {
-        int promoIdx = pieceIndex(move.promotionPiece);
-        zobristHash ^= zobrist.pieceKeys[movingIdx][toSq];
-        zobristHash ^= zobrist.pieceKeys[promoIdx][toSq];
-    }
-
-    // XOR out old castling rights
-    zobristHash ^= zobrist.castlingRightsKey[getCastlingRightsAsIndex(
-        context.previousCastleState)];
-    // XOR in new castling rights
-    zobristHash ^=
-        zobrist.castlingRightsKey[getCastlingRightsAsIndex(castleState)];
-
-    // XOR out old enPassant file
-    if (enPassantSquare != INVALID_SQUARE)
-        zobristHash ^= zobrist.enPassantFileKey[context.previousEnPassant.col];
-    // XOR out new enPassant file
-    if (enPassantSquare != INVALID_SQUARE)
-        zobristHash ^= zobrist.enPassantFileKey[enPassantSquare.col];
-
-    zobristHash ^= zobrist.sideToMoveKey;
+/**
+ * The piece planes are the piece bitboards; the other planes are either
+ * full or empty, except en passant which marks a whole file.
+ */
+InputPlanes Position::getInputPlanes() const {
+    InputPlanes planes{};
+    for (int i = 0; i < 12; ++i)
+        planes[i] = state.pieceBitboards[i];
+
+    const CastlingState &castleState = state.castleState;
+    planes[12] = (state.turn == WHITE) ? ALL_SQUARES : EMPTY_BITBOARD;
+    planes[13] = (castleState.white & KING_SIDE) ? ALL_SQUARES : EMPTY_BITBOARD;
+    planes[14] = (castleState.white & QUEEN_SIDE) ? ALL_SQUARES : EMPTY_BITBOARD;
+    planes[15] = (castleState.black & KING_SIDE) ? ALL_SQUARES : EMPTY_BITBOARD;
+    planes[16] = (castleState.black & QUEEN_SIDE) ? ALL_SQUARES : EMPTY_BITBOARD;
+
+    if (state.enPassantIndex >= 0)
+        planes[17] = 0x0101010101010101ULL << (state.enPassantIndex & 7);
+    return planes;
 }
 
-void Position::initInputTensor() {
-    clearAllPlanes(inputTensor);
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            setPiecePlane(inputTensor, board[row][col], row, col);
-        }
-    }
-
-    if (turn == WHITE) {
-        fillPlane(inputTensor, 12, 1.0f);
-    }
-
-    if (castleState.white & KING_SIDE)
-        fillPlane(inputTensor, 13, 1.0f);
-    if (castleState.white & QUEEN_SIDE)
-        fillPlane(inputTensor, 14, 1.0f);
-    if (castleState.black & KING_SIDE)
-        fillPlane(inputTensor, 15, 1.0f);
-    if (castleState.black & QUEEN_SIDE)
-        fillPlane(inputTensor, 16, 1.0f);
+void Position::writeInputTensor(float *out) const {
+    expandPlanes(getInputPlanes(), out);
+}
 
-    if (enPassantSquare.isValid()) {
-        int file = enPassantSquare.col;
-        if (file >= 0 && file < BOARD_SIZE) {
-            for (int r = 0; r < BOARD_SIZE; ++r) {
-                inputTensor[tensorIndex(17, r, file)] = 1.0f;
-            }
-        }
-    }
+/**
+ * Built from the board on demand, so moves made by a search that never
+ * reads it do not pay for keeping it up to date.
+ */
+std::array<float, 18 * 8 * 8> Position::getInputTensor() const {
+    std::array<float, 18 * 8 * 8> inputTensor;
+    writeInputTensor(inputTensor.data());
+    return inputTensor;
 }
 
 int Position::getCastlingRightsAsIndex(CastlingState state) const {
@@ -322,87 +267,59 @@ int Position::getCastlingRightsAsIndex(CastlingState state) const {
     return index;
 }
 
-void Position::addPieceSquare(Square s, Color c) {
-    if (c == WHITE) {
-        piecesSquares.white.insert(s);
-    } else if (c == BLACK) {
-        piecesSquares.black.insert(s);
-    }
-}
-
-void Position::removePieceSquare(Square s, Color c) {
-    if (c == WHITE) {
-        piecesSquares.white.erase(s);
-    } else if (c == BLACK) {
-        piecesSquares.black.erase(s);
-    }
-}
-
 void Position::setEnPassantSquare(Square square) {
-    this->enPassantSquare = square;
-    fillPlane(this->inputTensor, 17, 0.0f);
-    if (this->enPassantSquare.isValid()) {
-        int file = this->enPassantSquare.col;
-        for (int r = 0; r < BOARD_SIZE; ++r) {
-            this->inputTensor[tensorIndex(17, r, file)] = 1.0f;
-        }
-    }
+    if (state.enPassantIndex >= 0)
+        state.zobristHash ^= ZOBRIST.enPassantFileKey[state.enPassantIndex & 7];
+    if (square.isValid())
+        state.zobristHash ^= ZOBRIST.enPassantFileKey[square.col];
+    state.enPassantIndex = square.isValid() ? squareIndex(square) : -1;
 }
 
-void Position::setCastleState(Color color, int state) {
+void Position::setCastleState(Color color, int rights) {
+    CastlingState &castleState = state.castleState;
+    state.zobristHash ^=
+        ZOBRIST.castlingRightsKey[getCastlingRightsAsIndex(castleState)];
     if (color == WHITE) {
-        this->castleState.white = state;
-        if (!(state & KING_SIDE) || !(state & QUEEN_SIDE)) {
-            fillPlane(this->inputTensor, 13, 0.0f);
-            fillPlane(this->inputTensor, 14, 0.0f);
-        }
-        if (state & KING_SIDE) {
-            fillPlane(this->inputTensor, 13, 1.0f);
-        }
-        if (state & QUEEN_SIDE) {
-            fillPlane(this->inputTensor, 14, 1.0f);
-        }
+        castleState.white = rights;
     } else {
-        this->castleState.black = state;
-        if (!(state & KING_SIDE) || !(state & QUEEN_SIDE)) {
-            fillPlane(this->inputTensor, 15, 0.0f);
-            fillPlane(this->inputTensor, 16, 0.0f);
-        }
-        if (state & KING_SIDE) {
-            fillPlane(this->inputTensor, 15, 1.0f);
-        }
-        if (state & QUEEN_SIDE) {
-            fillPlane(this->inputTensor, 16, 1.0f);
-        }
+        castleState.black = rights;
     }
+    state.zobristHash ^=
+        ZOBRIST.castlingRightsKey[getCastlingRightsAsIndex(castleState)];
 }
 
-Square Position::getEnPassantSquare() const { return this->enPassantSquare; }
+Square Position::getEnPassantSquare() const {
+    return state.enPassantIndex >= 0 ? indexToSquare(state.enPassantIndex)
+                                     : INVALID_SQUARE;
+}
 
-Color Position::getTurn() const { return turn; }
+Color Position::getTurn() const { return state.turn; }
 
 int Position::getCastleState(Color color) const {
-    return (color == WHITE) ? castleState.white : castleState.black;
+    return (color == WHITE) ? state.castleState.white
+                            : state.castleState.black;
 }
 
 std::unordered_set<Square> Position::getPiecesSquares(Color color) const {
-    return (color == WHITE) ? piecesSquares.white : piecesSquares.black;
+    std::unordered_set<Square> squares;
+    Bitboard pieces = getPieces(color);
+    while (pieces) {
+        squares.insert(indexToSquare(popLsb(pieces)));
+    }
+    return squares;
 }
 
 void Position::increaseMoveCounts(const ColoredPiece movingCP,
                                   const ColoredPiece capturedCP) {
     if (movingCP.piece == PAWN) {
-        this->halfmoveClock = 0;
+        state.halfmoveClock = 0;
     } else if (capturedCP != NO_COLORED_PIECE) {
-        this->halfmoveClock = 0;
+        state.halfmoveClock = 0;
     } else {
-        this->halfmoveClock++;
+        state.halfmoveClock++;
     }
 
     bool isWhitesTurn = (this->getTurn() == WHITE);
-    this->fullmoveNumber += isWhitesTurn ? 0 : 1;
+    state.fullmoveNumber += isWhitesTurn ? 0 : 1;
 }
 
-std::array<float, 18 * 8 * 8> Position::getInputTensor() const {
-    return this->inputTensor;
-}
\ No newline at end of file
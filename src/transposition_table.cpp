@@ -0,0 +1,126 @@
+#include "transposition_table.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+template <typename T> T loadRelaxed(const T &value) {
+    return std::atomic_ref<T>(const_cast<T &>(value))
+        .load(std::memory_order_relaxed);
+}
+
+template <typename T> void storeRelaxed(T &slot, T value) {
+    std::atomic_ref<T>(slot).store(value, std::memory_order_relaxed);
+}
+
+/** All 64 bits of the data folded in, so any torn write changes the XOR. */
+uint16_t fold(uint64_t data) {
+    return static_cast<uint16_t>(data ^ (data >> 16) ^ (data >> 32) ^
+                                 (data >> 48));
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t sizeMb) { resize(sizeMb); }
+
+void TranspositionTable::resize(size_t sizeMb) {
+    size_t count = std::max<size_t>(1, sizeMb * 1024 * 1024 / sizeof(Bucket));
+    // Built aside, so a failed allocation leaves the current table in place
+    std::vector<Bucket> resized(std::bit_floor(count));
+    buckets.swap(resized);
+}
+
+void TranspositionTable::clear() {
+    // Below 64 MB per thread, starting threads costs more than it saves
+    constexpr size_t bucketsPerThread = (64 << 20) / sizeof(Bucket);
+    size_t threadCount =
+        std::clamp<size_t>(buckets.size() / bucketsPerThread, 1,
+                           std::max(1u, std::thread::hardware_concurrency()));
+    size_t slice = (buckets.size() + threadCount - 1) / threadCount;
+
+    std::vector<std::thread> threads;
+    for (size_t start = slice; start < buckets.size(); start += slice) {
+        size_t count = std::min(slice, buckets.size() - start);
+        threads.emplace_back([this, start, count]() {
+            std::memset(&buckets[start], 0, count * sizeof(Bucket));
+        });
+    }
+    std::memset(buckets.data(), 0, std::min(slice, buckets.size()) *
+                                       sizeof(Bucket));
+    for (std::thread &thread : threads)
+        thread.join();
+
+    generation8 = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry &entry) const {
+    const Bucket &bucket = buckets[bucketIndex(key)];
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        uint64_t data = loadRelaxed(bucket.data[i]);
+        if (data &&
+            (loadRelaxed(bucket.checks[i]) ^ fold(data)) == keyCheck(key)) {
+            entry = std::bit_cast<TTEntry>(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Overwrites the entry of the same position, else an empty slot, else the
+ * entry with the lowest replacement value. A bound from a shallower search
+ * does not replace a deeper entry of the current search; exact scores and
+ * entries of earlier searches are always replaced. A result without a best
+ * move keeps the one already stored for the position. Depths beyond the 8 bits
+ * of the entry are stored as the deepest one it can hold.
+ */
+void TranspositionTable::store(uint64_t key, int score, int eval, int depth,
+                               NodeType type, Move bestMove) {
+    Bucket &bucket = buckets[bucketIndex(key)];
+    uint16_t key16 = keyCheck(key);
+
+    int replace = -1;
+    int weakest = 0;
+    int weakestValue = INT_MAX;
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        uint64_t data = loadRelaxed(bucket.data[i]);
+        if (!data) {
+            replace = i;
+            break;
+        }
+        TTEntry entry = std::bit_cast<TTEntry>(data);
+        if ((loadRelaxed(bucket.checks[i]) ^ fold(data)) == key16) {
+            bool current = (entry.genBound8 & ~0x3) == generation8;
+            if (current && type != EXACT && depth < entry.depth())
+                return;
+            replace = i;
+            if (bestMove == Move())
+                bestMove = entry.bestMove;
+            break;
+        }
+        if (replacementValue(entry) < weakestValue) {
+            weakest = i;
+            weakestValue = replacementValue(entry);
+        }
+    }
+    if (replace < 0)
+        replace = weakest;
+
+    uint64_t data = std::bit_cast<uint64_t>(
+        TTEntry{bestMove, static_cast<int16_t>(score),
+                static_cast<int16_t>(eval),
+                static_cast<int8_t>(std::clamp(depth, 0, int(INT8_MAX))),
+                static_cast<uint8_t>(generation8 | type)});
+    storeRelaxed(bucket.data[replace], data);
+    storeRelaxed(bucket.checks[replace], uint16_t(key16 ^ fold(data)));
+}
+
+int TranspositionTable::replacementValue(const TTEntry &entry) const {
+    int age = uint8_t(generation8 - (entry.genBound8 & ~0x3)) /
+              GENERATION_DELTA;
+    return entry.depth() - AGE_PENALTY * age;
+}
@@ -54,10 +54,10 @@ ColoredPiece charToColoredPiece(char c) {
 }
 
 std::string getMoveString(Move move) {
-    char fromCol = 'a' + move.from.col;
-    char fromRow = '1' + (7 - move.from.row);
-    char toCol = 'a' + move.to.col;
-    char toRow = '1' + (7 - move.to.row);
+    char fromCol = 'a' + move.from().col;
+    char fromRow = '1' + (7 - move.from().row);
+    char toCol = 'a' + move.to().col;
+    char toRow = '1' + (7 - move.to().row);
     std::string moveStr;
     moveStr += fromCol;
     moveStr += fromRow;
@@ -80,36 +80,3 @@ size_t tensorIndex(int plane, int row, int col) {
     return static_cast<size_t>(plane) * BOARD_SIZE * BOARD_SIZE +
            row * BOARD_SIZE + col;
 }
-
-void clearAllPlanes(
-    std::array<float, NUM_PLANES * BOARD_SIZE * BOARD_SIZE> &tensor) {
-    tensor.fill(0.0f);
-}
-
-void clearPiecePlanes(
-    std::array<float, NUM_PLANES * BOARD_SIZE * BOARD_SIZE> &tensor, int r,
-    int c) {
-    for (int p = 0; p < 12; ++p) {
-        tensor[tensorIndex(p, r, c)] = 0.0f;
-    }
-}
-
-void setPiecePlane(
-    std::array<float, NUM_PLANES * BOARD_SIZE * BOARD_SIZE> &tensor,
-    const ColoredPiece &cp, int r, int c) {
-    if (cp.piece == EMPTY || cp.color == NONE)
-        return;
-    int plane_base = (cp.color == WHITE) ? 0 : 6;
-    int piece_index = static_cast<int>(cp.piece);
-    int piece_plane = plane_base + (piece_index - 1);
-    if (piece_plane >= 0 && piece_plane < 12) {
-        tensor[tensorIndex(piece_plane, r, c)] = 1.0f;
-    }
-}
-
-void fillPlane(std::array<float, NUM_PLANES * BOARD_SIZE * BOARD_SIZE> &tensor,
-               int plane, float v) {
-    for (int r = 0; r < BOARD_SIZE; ++r)
-        for (int c = 0; c < BOARD_SIZE; ++c)
-            tensor[tensorIndex(plane, r, c)] = v;
-}
@@ -1,5 +1,8 @@
 #include "uci.h"
+#include "attacks.h"
 #include "engine.h"
+#include "perft.h"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -7,21 +10,75 @@ const std::string START_FEN =
     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
 void parsePositionCommand(const std::string &line, Position &pos) {
+    size_t movesIdx = line.find("moves");
     if (line.find("startpos") != std::string::npos) {
         pos.loadFEN(START_FEN);
-        size_t movesIdx = line.find("moves");
-        if (movesIdx != std::string::npos) {
-            std::istringstream iss(line.substr(movesIdx + 6));
-            std::string moveStr;
-            while (iss >> moveStr) {
-                Move move = pos.moveParser.uciToMove(moveStr);
-                pos.moveMaker.makeLegalMove(move);
-                pos.printBoard();
-            }
+    } else if (size_t fenIdx = line.find("fen"); fenIdx != std::string::npos) {
+        pos.loadFEN(line.substr(fenIdx + 4, movesIdx == std::string::npos
+                                                ? std::string::npos
+                                                : movesIdx - fenIdx - 4));
+    } else {
+        return;
+    }
+
+    if (movesIdx != std::string::npos) {
+        std::istringstream iss(line.substr(movesIdx + 6));
+        std::string moveStr;
+        while (iss >> moveStr) {
+            Move move = pos.moveParser.uciToMove(moveStr);
+            pos.moveMaker.makeLegalMove(move);
+            pos.printBoard();
         }
     }
 }
 
+/**
+ * "go perft <depth> [hash MB] [threads]": prints the leaf count below every
+ * root move, then the total and the nodes per second. 0 threads uses every
+ * hardware thread.
+ */
+void goPerft(std::istringstream &iss, Position &pos) {
+    int depth = 1;
+    size_t hashSizeMb = 0;
+    unsigned threads = 1;
+    iss >> depth >> hashSizeMb >> threads;
+    Perft perft(&pos, hashSizeMb, threads);
+    perft.report(depth, true, std::cout);
+}
+
+/**
+ * "setoption name <name> value <value>". Options:
+ * CopyMake (check): search with copy-make instead of make/unmake.
+ * Pext (check): BMI2 PEXT slider lookups, ignored if the CPU lacks them.
+ * Hash (spin): transposition table size in MB.
+ */
+void setOption(const std::string &line, Engine &engine) {
+    std::istringstream iss(line);
+    std::string token, name, value;
+    iss >> token >> token >> name >> token >> value;
+    if (name == "CopyMake")
+        engine.setMakeMode(value == "true" ? COPY_MAKE : MAKE_UNMAKE);
+    else if (name == "Pext")
+        initSliderAttacks(value == "true" ? PEXT_SLIDERS : MAGIC_SLIDERS);
+    else if (name == "Hash")
+        setHashOption(value, engine);
+}
+
+/**
+ * Resizes the transposition table, clamping the size to the advertised
+ * range. A value that is not a number, or a size the machine cannot
+ * allocate, leaves the table as it is.
+ */
+void setHashOption(const std::string &value, Engine &engine) {
+    try {
+        long long sizeMb = std::clamp<long long>(
+            std::stoll(value), TranspositionTable::MIN_SIZE_MB,
+            TranspositionTable::MAX_SIZE_MB);
+        engine.setHashSize(static_cast<size_t>(sizeMb));
+    } catch (const std::exception &) {
+    }
+}
+
 void uciLoop() {
     Position position;
     Engine engine(&position);
@@ -31,11 +88,31 @@ void uciLoop() {
         if (line == "uci") {
             std::cout << "id name SimpleEngine\n";
             std::cout << "id author Lextraz\n";
+            std::cout << "info string slider attacks: "
+                      << (sliderBackend == PEXT_SLIDERS ? "pext" : "magic")
+                      << "\n";
+            std::cout << "option name CopyMake type check default "
+                      << (position.moveMaker.getMakeMode() == COPY_MAKE
+                              ? "true"
+                              : "false")
+                      << "\n";
+            std::cout << "option name Pext type check default "
+                      << (sliderBackend == PEXT_SLIDERS ? "true" : "false")
+                      << "\n";
+            std::cout << "option name Hash type spin default "
+                      << TranspositionTable::DEFAULT_SIZE_MB << " min "
+                      << TranspositionTable::MIN_SIZE_MB << " max "
+                      << TranspositionTable::MAX_SIZE_MB << "\n";
             std::cout << "uciok\n";
         } else if (line == "isready") {
             std::cout << "readyok\n";
+        } else if (line.rfind("setoption", 0) == 0) {
+            setOption(line, engine);
         } else if (line.rfind("position", 0) == 0) {
             parsePositionCommand(line, position);
+        } else if (line.rfind("go perft", 0) == 0) {
+            std::istringstream iss(line.substr(8));
+            goPerft(iss, position);
         } else if (line.rfind("go", 0) == 0) {
             int movetime = 1000; // default one second
             std::istringstream iss(line);
@@ -51,6 +128,7 @@ void uciLoop() {
             break;
         } else if (line == "ucinewgame") {
             position.loadFEN(START_FEN);
+            engine.newGame();
         }
     }
 }
@@ -0,0 +1,104 @@
+#include "../../include/move_maker.h"
+#include "../../include/perft.h"
+#include "../../include/position.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Full-tree regression over the positions in perft_suite.epd, one per line:
+ * <fen> ;D<depth> <nodes> ;D<depth> <nodes> ...
+ * Runs single threaded without a hash, so the nodes per second measure move
+ * generation alone. Fails on any node count mismatch in either make mode,
+ * and when the copy-make rate falls below PERFT_MIN_NPS (unset or 0
+ * disables the check).
+ */
+
+namespace {
+
+struct PerftCase {
+    std::string fen;
+    int depth;
+    uint64_t nodes;
+};
+
+std::vector<PerftCase> loadSuite(const std::string &path) {
+    std::vector<PerftCase> cases;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string fen, entry;
+        if (!std::getline(fields, fen, ';') || fen.empty())
+            continue;
+        while (std::getline(fields, entry, ';')) {
+            std::istringstream iss(entry);
+            char d;
+            PerftCase perftCase{fen, 0, 0};
+            if (iss >> d >> perftCase.depth >> perftCase.nodes && d == 'D')
+                cases.push_back(perftCase);
+        }
+    }
+    return cases;
+}
+
+/**
+ * Runs every case of the suite with the given make mode.
+ * @returns the total node count, adding the time spent to totalTime.
+ */
+uint64_t runSuite(const std::vector<PerftCase> &cases, SearchMakeMode mode,
+                  std::chrono::duration<double> &totalTime) {
+    Position position;
+    position.moveMaker.setMakeMode(mode);
+    Perft perft(&position);
+    uint64_t totalNodes = 0;
+
+    for (const PerftCase &perftCase : cases) {
+        position.loadFEN(perftCase.fen);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft.perft(perftCase.depth);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(nodes, perftCase.nodes)
+            << perftCase.fen << " at depth " << perftCase.depth;
+        totalNodes += nodes;
+        totalTime += elapsed;
+    }
+    return totalNodes;
+}
+
+} // namespace
+
+TEST(PerftSuiteTest, StandardPositions) {
+    std::vector<PerftCase> cases = loadSuite(PERFT_SUITE_FILE);
+    ASSERT_FALSE(cases.empty()) << "no cases in " << PERFT_SUITE_FILE;
+
+    std::chrono::duration<double> totalTime{0};
+    uint64_t totalNodes = runSuite(cases, COPY_MAKE, totalTime);
+
+    uint64_t nps = static_cast<uint64_t>(totalNodes / totalTime.count());
+    std::cout << "perft suite: " << totalNodes << " nodes in "
+              << totalTime.count() << " s, " << nps << " nps\n";
+    RecordProperty("nodes", std::to_string(totalNodes));
+    RecordProperty("nps", std::to_string(nps));
+
+    const char *minNps = std::getenv("PERFT_MIN_NPS");
+    if (minNps && std::strtoull(minNps, nullptr, 10) > 0) {
+        EXPECT_GE(nps, std::strtoull(minNps, nullptr, 10))
+            << "move generation throughput regressed";
+    }
+}
+
+/** Same node counts when doMove/undoMove reverse moves in place. */
+TEST(PerftSuiteTest, StandardPositionsMakeUnmake) {
+    std::vector<PerftCase> cases = loadSuite(PERFT_SUITE_FILE);
+    ASSERT_FALSE(cases.empty()) << "no cases in " << PERFT_SUITE_FILE;
+
+    std::chrono::duration<double> totalTime{0};
+    runSuite(cases, MAKE_UNMAKE, totalTime);
+}
@@ -0,0 +1,114 @@
+#include "../include/attacks.h"
+#include "../include/bitboard.h"
+#include "../include/types.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+static Bitboard squaresToBitboard(std::initializer_list<Square> squares) {
+    Bitboard bb = EMPTY_BITBOARD;
+    for (Square s : squares)
+        bb |= squareBitboard(s);
+    return bb;
+}
+
+TEST(AttacksTest, RookAttacks) {
+    int d4 = squareIndex(Square(4, 3));
+
+    EXPECT_EQ(popCount(rookAttacks(d4, EMPTY_BITBOARD)), 14);
+
+    Bitboard blockers = squaresToBitboard({Square(2, 3), Square(4, 1)});
+    Bitboard expected = squaresToBitboard(
+        {Square(3, 3), Square(2, 3), Square(5, 3), Square(6, 3), Square(7, 3),
+         Square(4, 2), Square(4, 1), Square(4, 4), Square(4, 5), Square(4, 6),
+         Square(4, 7)});
+    EXPECT_EQ(rookAttacks(d4, blockers), expected);
+
+    int a8 = squareIndex(Square(0, 0));
+    blockers = squaresToBitboard({Square(0, 1), Square(1, 0)});
+    EXPECT_EQ(rookAttacks(a8, blockers), blockers);
+}
+
+TEST(AttacksTest, BishopAttacks) {
+    int c1 = squareIndex(Square(7, 2));
+
+    Bitboard expected = squaresToBitboard({Square(6, 1), Square(5, 0),
+                                           Square(6, 3), Square(5, 4),
+                                           Square(4, 5), Square(3, 6),
+                                           Square(2, 7)});
+    EXPECT_EQ(bishopAttacks(c1, EMPTY_BITBOARD), expected);
+
+    Bitboard blockers = squaresToBitboard({Square(5, 4), Square(2, 7)});
+    expected = squaresToBitboard(
+        {Square(6, 1), Square(5, 0), Square(6, 3), Square(5, 4)});
+    EXPECT_EQ(bishopAttacks(c1, blockers), expected);
+
+    int e4 = squareIndex(Square(4, 4));
+    EXPECT_EQ(queenAttacks(e4, blockers),
+              rookAttacks(e4, blockers) | bishopAttacks(e4, blockers));
+}
+
+TEST(AttacksTest, LeaperAttacks) {
+    int g1 = squareIndex(Square(7, 6));
+    EXPECT_EQ(knightAttacks(g1),
+              squaresToBitboard({Square(5, 5), Square(5, 7), Square(6, 4)}));
+
+    int a1 = squareIndex(Square(7, 0));
+    EXPECT_EQ(kingAttacks(a1),
+              squaresToBitboard({Square(6, 0), Square(6, 1), Square(7, 1)}));
+
+    int e4 = squareIndex(Square(4, 4));
+    EXPECT_EQ(pawnAttacks(WHITE, e4),
+              squaresToBitboard({Square(3, 3), Square(3, 5)}));
+    EXPECT_EQ(pawnAttacks(BLACK, e4),
+              squaresToBitboard({Square(5, 3), Square(5, 5)}));
+}
+
+TEST(AttacksTest, GeometryTables) {
+    int a1 = squareIndex(Square(7, 0)), h8 = squareIndex(Square(0, 7));
+    int c3 = squareIndex(Square(5, 2)), e4 = squareIndex(Square(4, 4));
+    int b1 = squareIndex(Square(7, 1)), e3 = squareIndex(Square(5, 4));
+    // a8 knight reaches c7 and b6, known at compile time
+    static_assert(knightAttacks(0) == (squareBitboard(10) | squareBitboard(17)));
+
+    EXPECT_EQ(betweenSquares(a1, h8) & squareBitboard(c3), squareBitboard(c3));
+    EXPECT_EQ(popCount(betweenSquares(a1, h8)), 6);
+    EXPECT_EQ(betweenSquares(a1, e4), EMPTY_BITBOARD);
+    EXPECT_EQ(lineThrough(c3, h8), lineThrough(a1, h8));
+    EXPECT_EQ(popCount(lineThrough(a1, h8)), 8);
+    EXPECT_EQ(lineThrough(b1, e3), EMPTY_BITBOARD);
+    EXPECT_EQ(squareDistance(a1, h8), 7);
+    EXPECT_EQ(squareDistance(c3, e4), 2);
+    EXPECT_EQ(squareDistance(e4, e4), 0);
+}
+
+TEST(AttacksTest, PextMatchesMagic) {
+    if (!cpuHasFastPext())
+        GTEST_SKIP() << "CPU has no fast PEXT";
+
+    SliderBackend original = sliderBackend;
+    uint64_t seed = 0x123456789ABCDEFULL;
+    auto nextOccupancy = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed & (seed >> 3);
+    };
+
+    std::vector<Bitboard> occupancies;
+    for (int i = 0; i < 64; ++i)
+        occupancies.push_back(nextOccupancy());
+
+    ASSERT_TRUE(initSliderAttacks(MAGIC_SLIDERS));
+    std::vector<Bitboard> magicAttacks;
+    for (int square = 0; square < 64; ++square)
+        for (Bitboard occ : occupancies)
+            magicAttacks.push_back(queenAttacks(square, occ));
+
+    ASSERT_TRUE(initSliderAttacks(PEXT_SLIDERS));
+    size_t i = 0;
+    for (int square = 0; square < 64; ++square)
+        for (Bitboard occ : occupancies)
+            EXPECT_EQ(queenAttacks(square, occ), magicAttacks[i++]);
+
+    initSliderAttacks(original);
+}
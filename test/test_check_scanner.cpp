@@ -50,6 +50,29 @@ TEST(CheckScannerTest, IsInStalemate) {
     EXPECT_TRUE(scanner.isInStalemate(BLACK));
 }
 
+TEST(CheckScannerTest, GetGameStatus) {
+    Position position;
+    CheckScanner scanner(&position);
+
+    EXPECT_EQ(scanner.getGameStatus(WHITE), IN_PROGRESS);
+    EXPECT_TRUE(position.movementValidator.hasAnyLegalMove(WHITE));
+
+    position.loadFEN(
+        "r1bqkb1r/pp1ppBpp/2n2n2/2p4Q/4P3/8/PPPP1PPP/RNB1K1NR b KQkq - 0 4");
+    EXPECT_EQ(scanner.getGameStatus(BLACK), CHECKMATE);
+    EXPECT_TRUE(position.getIsGameOver());
+
+    position.loadFEN("3k4/3P4/3K4/8/8/8/8/8 b - - 0 1");
+    EXPECT_EQ(scanner.getGameStatus(BLACK), STALEMATE);
+    EXPECT_FALSE(position.movementValidator.hasAnyLegalMove(BLACK));
+
+    // The king has no safe square, so a blocked or free pawn decides it
+    position.loadFEN("7k/5Q2/8/8/8/8/p7/K7 b - - 0 1");
+    EXPECT_EQ(scanner.getGameStatus(BLACK), STALEMATE);
+    position.loadFEN("7k/5Q2/8/8/8/p7/8/K7 b - - 0 1");
+    EXPECT_EQ(scanner.getGameStatus(BLACK), IN_PROGRESS);
+}
+
 TEST(CheckScannerTest, IsSquareInCheck) {
     Position position;
     position.loadFEN(
@@ -67,4 +90,24 @@ TEST(CheckScannerTest, IsSquareInCheck) {
     EXPECT_TRUE(scanner.isSquareInCheck(Square(4, 4), WHITE));
     EXPECT_TRUE(scanner.isSquareInCheck(Square(4, 3), WHITE));
     EXPECT_TRUE(scanner.isSquareInCheck(Square(2, 3), WHITE));
-}
\ No newline at end of file
+}
+
+TEST(CheckScannerTest, AttackersTo) {
+    Position position;
+    position.loadFEN("4k3/3r4/8/3p4/4P3/2N5/3R4/3RK3 w - - 0 1");
+
+    CheckScanner scanner(&position);
+    int d5 = squareIndex(Square(3, 3));
+    Bitboard occupancy = position.getOccupancy();
+
+    Bitboard expected = squareBitboard(Square(4, 4)) |
+                        squareBitboard(Square(5, 2)) |
+                        squareBitboard(Square(6, 3)) |
+                        squareBitboard(Square(1, 3));
+    EXPECT_EQ(scanner.attackersTo(d5, occupancy), expected);
+
+    // Lifting the front rook reveals the one behind it
+    occupancy ^= squareBitboard(Square(6, 3));
+    EXPECT_EQ(scanner.attackersTo(d5, occupancy),
+              expected | squareBitboard(Square(7, 3)));
+}
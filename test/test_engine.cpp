@@ -1,6 +1,7 @@
 #include "../include/engine.h"
 #include "../include/position.h"
 #include "../include/types.h"
+#include <chrono>
 #include <gtest/gtest.h>
 
 TEST(ChessEngineTest, EvaluatePosition) {
@@ -63,6 +64,66 @@ TEST(ChessEngineTest, EvaluatePosition) {
     EXPECT_EQ(engine.evaluateLeaf(&position, WHITE, depth), 0);
 }
 
+TEST(ChessEngineTest, StaticExchangeEval) {
+    Position position;
+    Engine engine(&position);
+    Square d5(3, 3);
+
+    position.loadFEN("4k3/8/8/3p4/4P3/8/8/4K3 w - - 0 1");
+    EXPECT_EQ(engine.staticExchangeEval(&position, d5, WHITE), 100);
+
+    // Rook takes a defended pawn and is lost
+    position.loadFEN("4k3/8/4p3/3p4/8/8/3R4/4K3 w - - 0 1");
+    EXPECT_EQ(engine.staticExchangeEval(&position, d5, WHITE), -400);
+
+    // The rook behind joins as an x-ray and wins the exchange
+    position.loadFEN("4k3/3r4/8/3p4/8/8/3R4/3RK3 w - - 0 1");
+    EXPECT_EQ(engine.staticExchangeEval(&position, d5, WHITE), 100);
+
+    // The king cannot recapture while the x-ray rook still covers d5
+    position.loadFEN("8/8/8/3pk3/8/8/3R4/3RK3 w - - 0 1");
+    EXPECT_EQ(engine.staticExchangeEval(&position, d5, WHITE), 100);
+
+    position.loadFEN("4k3/8/8/3p4/8/8/8/4K3 w - - 0 1");
+    EXPECT_EQ(engine.staticExchangeEval(&position, d5, WHITE), 0);
+
+    // The move opens the exchange with the queen, not the cheaper pawn
+    position.loadFEN("4k3/8/4p3/3p4/4P3/8/3Q4/4K3 w - - 0 1");
+    EXPECT_EQ(engine.staticExchangeEval(&position, d5, WHITE), 100);
+    EXPECT_EQ(engine.staticExchangeEval(&position, Move(Square(6, 3), d5)),
+              -700);
+    EXPECT_EQ(engine.staticExchangeEval(&position, Move(Square(4, 4), d5)),
+              100);
+}
+
+TEST(ChessEngineTest, HistoryStaysBounded) {
+    Position position;
+    Engine engine(&position);
+    position.loadFEN("8/8/8/4k3/8/8/8/4K3 w - - 0 1");
+    Move move(Square(7, 4), Square(6, 4));
+
+    for (int i = 0; i < 100000; i++)
+        engine.recordCutoff(move, 140, 0);
+    int &score = engine.history[colorIndex(WHITE)][move.fromIndex()][move.toIndex()];
+    EXPECT_GT(score, 0);
+    EXPECT_LE(score, Engine::HISTORY_MAX);
+}
+
+TEST(ChessEngineTest, MateScoreCountsPlies) {
+    // Ra8 mates, one ply from the root whatever the search depth
+    for (int depth = 1; depth <= 3; ++depth) {
+        Position position;
+        position.loadFEN("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+        Engine engine(&position);
+        engine.startTime = std::chrono::steady_clock::now();
+        engine.timeLimitMs = 60000;
+        EXPECT_EQ(engine.negamax(&position, depth, -engine.INF, engine.INF,
+                                 WHITE, 0),
+                  engine.MATE_SCORE - 1)
+            << "depth " << depth;
+    }
+}
+
 TEST(ChessEngineTest, GetBestMoveCheckMateInOne) {
     Position position;
     Engine engine(&position);
@@ -0,0 +1,46 @@
+#include "../include/input_planes.h"
+#include "../include/position.h"
+#include "../include/types.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+TEST(InputPlanesTest, ExpandMatchesScalar) {
+    std::mt19937_64 rng(42);
+    InputPlanes planes;
+    for (Bitboard &plane : planes)
+        plane = rng();
+    planes[0] = EMPTY_BITBOARD;
+    planes[1] = ALL_SQUARES;
+
+    std::vector<float> expected(INPUT_TENSOR_SIZE), actual(INPUT_TENSOR_SIZE);
+    expandPlanesScalar(planes, expected.data());
+    expandPlanes(planes, actual.data());
+    EXPECT_EQ(actual, expected);
+
+    EXPECT_FLOAT_EQ(expected[tensorIndex(1, 7, 7)], 1.0f);
+    EXPECT_FLOAT_EQ(expected[tensorIndex(0, 0, 0)], 0.0f);
+}
+
+TEST(InputPlanesTest, PlanesFromPosition) {
+    Position position;
+    position.loadFEN(
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w Kq f6 0 3");
+    InputPlanes planes = position.getInputPlanes();
+
+    EXPECT_EQ(planes[0], position.getPieces(WHITE, PAWN));
+    EXPECT_EQ(planes[11], position.getPieces(BLACK, KING));
+    EXPECT_EQ(planes[12], ALL_SQUARES);
+    EXPECT_EQ(planes[13], ALL_SQUARES);
+    EXPECT_EQ(planes[14], EMPTY_BITBOARD);
+    EXPECT_EQ(planes[15], EMPTY_BITBOARD);
+    EXPECT_EQ(planes[16], ALL_SQUARES);
+    EXPECT_EQ(planes[17], 0x2020202020202020ULL);
+
+    // A batch slot holds the same floats as the standalone tensor
+    std::vector<float> batch(2 * INPUT_TENSOR_SIZE);
+    position.writeInputTensor(batch.data() + INPUT_TENSOR_SIZE);
+    auto tensor = position.getInputTensor();
+    EXPECT_TRUE(std::equal(tensor.begin(), tensor.end(),
+                           batch.begin() + INPUT_TENSOR_SIZE));
+}
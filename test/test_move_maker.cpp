@@ -241,6 +241,65 @@ TEST(MoveMakerTest, UndoMove) {
               "rnbqkbnr/ppp1p1pp/B7/3pPp2/8/8/PPPP1PPP/RNBQK1NR b KQkq - 1 3");
 }
 
+TEST(MoveMakerTest, DoUndoMove) {
+    Position position;
+    // En passant, castling both ways, promotions with and without capture
+    std::string fen =
+        "r3k2r/1P1pqpb1/bn2pnp1/2pPN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq c6 0 2";
+    position.loadFEN(fen);
+    Position reference(position);
+
+    for (SearchMakeMode mode : {MAKE_UNMAKE, COPY_MAKE}) {
+        position.moveMaker.setMakeMode(mode);
+        for (const Move &move :
+             position.movementValidator.getLegalMoves(WHITE)) {
+            reference.loadFEN(fen);
+            reference.moveMaker.makeLegalMove(move);
+
+            uint64_t key = position.moveMaker.keyAfter(move);
+            position.moveMaker.doMove(move);
+            EXPECT_EQ(position.getFEN(), reference.getFEN()) << move.toUCI();
+            EXPECT_EQ(position.getZobristHash(), reference.getZobristHash());
+            EXPECT_EQ(key, reference.getZobristHash()) << move.toUCI();
+
+            position.moveMaker.undoMove();
+            EXPECT_EQ(position.getFEN(), fen) << move.toUCI();
+        }
+    }
+
+    // The game history is left alone
+    position.moveMaker.unmakeMove();
+    EXPECT_EQ(position.getFEN(), fen);
+
+    // Black castles and takes en passant under the predicted key too
+    fen =
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1pP1P3/2N2Q1p/PP1BBPPP/R3K2R b KQkq c3 0 1";
+    position.loadFEN(fen);
+    for (const Move &move : position.movementValidator.getLegalMoves(BLACK)) {
+        uint64_t key = position.moveMaker.keyAfter(move);
+        position.moveMaker.doMove(move);
+        EXPECT_EQ(key, position.getZobristHash()) << move.toUCI();
+        position.moveMaker.undoMove();
+    }
+
+    // A rook away from its corner keeps the castling rights
+    position.loadFEN("r3k2r/8/8/8/7R/8/8/R3K3 w Qkq - 0 1");
+    position.moveMaker.doMove(Move(Square(4, 7), Square(4, 6)));
+    EXPECT_EQ(position.getCastleState(WHITE), QUEEN_SIDE);
+    position.moveMaker.makeLegalMove(Move(Square(0, 7), Square(1, 7)));
+    EXPECT_EQ(position.getFEN(), "r3k3/7r/8/8/6R1/8/8/R3K3 w Qq - 2 2");
+
+    // A stray promotion flag on a rook move must not demote it to a pawn
+    Position rookPosition;
+    rookPosition.moveMaker.setMakeMode(MAKE_UNMAKE);
+    fen = "4k3/1R6/8/8/8/8/8/4K3 w - - 0 1";
+    rookPosition.loadFEN(fen);
+    rookPosition.moveMaker.doMove(
+        Move(Square(1, 1), Square(0, 1), ColoredPiece(WHITE, QUEEN)));
+    rookPosition.moveMaker.undoMove();
+    EXPECT_EQ(rookPosition.getFEN(), fen);
+}
+
 TEST(MoveMakerTest, GetCapturedPiece) {
     Position position;
     std::string fen =
@@ -308,8 +367,7 @@ TEST(MoveMakerTest, GetMoveContext) {
         WHITE,
         true,
         false,
-        0xC5E095EAC036ADAA,
-        context.previousInputTensor};
+        0x4778FD70D95966A5};
 
     EXPECT_EQ(context, expectedContext);
 
@@ -329,8 +387,7 @@ TEST(MoveMakerTest, GetMoveContext) {
                        BLACK,
                        false,
                        false,
-                       0xD167AC3D0C9ADEDF,
-                       context.previousInputTensor};
+                       0x7524FB079F790837};
 
     EXPECT_EQ(context, expectedContext);
 
@@ -349,8 +406,7 @@ TEST(MoveMakerTest, GetMoveContext) {
                        WHITE,
                        false,
                        true,
-                       0xE3343C1917BB9EB8,
-                       context.previousInputTensor};
+                       0xBF4AA6C0710DDD61};
 
     EXPECT_EQ(context, expectedContext);
 }
@@ -94,4 +94,23 @@ TEST(MoveParser, StringToMove) {
     actualMove = parser.moveStringToMove(moveStr);
     expectedMove = Move(Square(6, 6), Square(7, 5), ColoredPiece(BLACK, ROOK));
     EXPECT_EQ(actualMove, expectedMove);
-}
\ No newline at end of file
+}
+
+TEST(MoveParser, UCIToMove) {
+    Position position;
+    MoveParser parser(&position);
+    position.loadFEN("8/1P6/8/8/8/8/8/k6K w - - 0 1");
+
+    Move move = parser.uciToMove("b7b8n");
+    EXPECT_EQ(move.from(), Square(1, 1));
+    EXPECT_EQ(move.to(), Square(0, 1));
+    EXPECT_EQ(move.promotionPiece(), ColoredPiece(WHITE, KNIGHT));
+    EXPECT_EQ(move.toUCI(), "b7b8n");
+
+    move = parser.uciToMove("h1g2");
+    EXPECT_FALSE(move.isPromotion());
+    EXPECT_EQ(move.toUCI(), "h1g2");
+
+    // Off-board squares give the null move rather than wrapping around
+    EXPECT_EQ(parser.uciToMove("h9h8"), Move());
+}
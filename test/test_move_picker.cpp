@@ -0,0 +1,61 @@
+#include "../include/engine.h"
+#include "../include/move_picker.h"
+#include "../include/position.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(MovePickerTest, StagedOrder) {
+    Position position;
+    position.loadFEN(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    Engine engine(&position);
+
+    Move ttMove(Square(7, 4), Square(7, 6));
+    Move killers[2] = {Move(Square(6, 0), Square(5, 0)),
+                       Move(Square(0, 0), Square(0, 1))}; // Not legal here
+    int history[64][64] = {};
+    MovePicker picker(&position, &engine, ttMove, killers, history);
+
+    std::vector<Move> picked;
+    for (Move move = picker.next(); move != Move(); move = picker.next())
+        picked.push_back(move);
+
+    MoveList legal = position.movementValidator.getLegalMoves(WHITE);
+    ASSERT_EQ(picked.size(), legal.size());
+    for (const Move &move : legal)
+        EXPECT_EQ(std::count(picked.begin(), picked.end(), move), 1);
+
+    // Hash move, captures, the killer, quiets, then the losing captures
+    EXPECT_EQ(picked.front(), ttMove);
+    auto killer = std::find(picked.begin(), picked.end(), killers[0]);
+    ASSERT_NE(killer, picked.end());
+    for (auto it = picked.begin() + 1; it != killer; ++it)
+        EXPECT_FALSE(picker.isQuiet(*it));
+    EXPECT_TRUE(picker.isQuiet(*(killer + 1)));
+    EXPECT_FALSE(picker.isQuiet(picked.back()));
+    // The queen takes the knight on f6 defended by the g7 bishop
+    EXPECT_NE(std::find(killer, picked.end(),
+                        Move(Square(5, 5), Square(2, 5))),
+              picked.end());
+}
+
+TEST(MovePickerTest, InvalidTTMoveSkipped) {
+    Position position;
+    position.loadFEN("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1");
+    Engine engine(&position);
+
+    // An entry of another position: a rook move from an empty square
+    Move ttMove(Square(7, 0), Square(0, 0));
+    Move killers[2] = {Move(), Move()};
+    int history[64][64] = {};
+    MovePicker picker(&position, &engine, ttMove, killers, history);
+
+    std::vector<Move> picked;
+    for (Move move = picker.next(); move != Move(); move = picker.next())
+        picked.push_back(move);
+
+    EXPECT_EQ(picked.size(),
+              position.movementValidator.getLegalMoves(WHITE).size());
+    EXPECT_EQ(std::count(picked.begin(), picked.end(), ttMove), 0);
+}
@@ -79,6 +79,31 @@ TEST(MovementValidatorTest, PawnBadMovement) {
     EXPECT_FALSE(validator.isValidMove(lastRankNoPromotion));
 }
 
+TEST(MovementValidatorTest, PromotionFlagsBadMovement) {
+    Position position;
+    position.loadFEN("4k3/1R6/8/8/8/8/8/4K3 w - - 0 1");
+    MovementValidator validator(&position);
+
+    Move b7b8(Square(1, 1), Square(0, 1));
+    EXPECT_TRUE(validator.isValidMove(b7b8));
+    EXPECT_FALSE(validator.isValidMove(
+        Move(Square(1, 1), Square(0, 1), ColoredPiece(WHITE, QUEEN))));
+
+    position.loadFEN("4k3/1P6/8/8/8/8/8/4K3 w - - 0 1");
+    EXPECT_TRUE(validator.isValidMove(
+        Move(Square(1, 1), Square(0, 1), ColoredPiece(WHITE, KNIGHT))));
+    EXPECT_FALSE(validator.isValidMove(
+        Move(Square(1, 1), Square(0, 1), ColoredPiece(WHITE, KING))));
+    EXPECT_FALSE(validator.isValidMove(
+        Move(Square(1, 1), Square(0, 1), ColoredPiece(WHITE, PAWN))));
+    EXPECT_FALSE(validator.isValidMove(
+        Move(Square(1, 1), Square(0, 1), ColoredPiece(BLACK, QUEEN))));
+
+    position.loadFEN("4k3/8/1P6/8/8/8/8/4K3 w - - 0 1");
+    EXPECT_FALSE(validator.isValidMove(
+        Move(Square(2, 1), Square(1, 1), ColoredPiece(WHITE, QUEEN))));
+}
+
 TEST(MovementValidatorTest, BishopGoodMovement) {
     Position position;
     position.loadFEN(
@@ -358,19 +383,19 @@ TEST(MovementValidatorTest, GetLegalMoves) {
 
     MovementValidator validator(&position);
 
-    std::vector<Move> legalMoves = validator.getLegalMoves(BLACK);
+    MoveList legalMoves = validator.getLegalMoves(BLACK);
 
     EXPECT_FALSE(
-        vectorContainsMove(legalMoves, Move(Square(0, 0), Square(0, 0))));
+        legalMoves.contains(Move(Square(0, 0), Square(0, 0))));
     EXPECT_FALSE(
-        vectorContainsMove(legalMoves, Move(Square(1, 3), Square(3, 3))));
+        legalMoves.contains(Move(Square(1, 3), Square(3, 3))));
     EXPECT_FALSE(
-        vectorContainsMove(legalMoves, Move(Square(0, 1), Square(2, 2))));
+        legalMoves.contains(Move(Square(0, 1), Square(2, 2))));
 
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(0, 4), Square(1, 5))));
+        legalMoves.contains(Move(Square(0, 4), Square(1, 5))));
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(0, 4), Square(1, 4))));
+        legalMoves.contains(Move(Square(0, 4), Square(1, 4))));
 
     fen = "r1bqk2r/pp1pppbp/2n2np1/8/3NP3/2N5/PPP1BPPP/R1BQK2R w KQkq - 3 7";
     position.loadFEN(fen);
@@ -378,13 +403,13 @@ TEST(MovementValidatorTest, GetLegalMoves) {
     legalMoves = validator.getLegalMoves(WHITE);
 
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(7, 4), Square(7, 6))));
+        legalMoves.contains(Move(Square(7, 4), Square(7, 6))));
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(4, 3), Square(2, 2))));
+        legalMoves.contains(Move(Square(4, 3), Square(2, 2))));
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(4, 4), Square(3, 4))));
+        legalMoves.contains(Move(Square(4, 4), Square(3, 4))));
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(7, 3), Square(6, 3))));
+        legalMoves.contains(Move(Square(7, 3), Square(6, 3))));
 
     fen = "r3kb1r/pppN1ppp/2n1pB2/8/2B3b1/2N5/PPpQ1PPP/R3K2R b KQkq - 0 10";
     position.loadFEN(fen);
@@ -392,75 +417,145 @@ TEST(MovementValidatorTest, GetLegalMoves) {
     legalMoves = validator.getLegalMoves(BLACK);
 
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(6, 2), Square(7, 2),
+        legalMoves.contains(Move(Square(6, 2), Square(7, 2),
                                             ColoredPiece(BLACK, QUEEN))));
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(6, 2), Square(7, 2),
+        legalMoves.contains(Move(Square(6, 2), Square(7, 2),
                                             ColoredPiece(BLACK, ROOK))));
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(6, 2), Square(7, 2),
+        legalMoves.contains(Move(Square(6, 2), Square(7, 2),
                                             ColoredPiece(BLACK, BISHOP))));
     EXPECT_TRUE(
-        vectorContainsMove(legalMoves, Move(Square(6, 2), Square(7, 2),
+        legalMoves.contains(Move(Square(6, 2), Square(7, 2),
                                             ColoredPiece(BLACK, KNIGHT))));
     EXPECT_FALSE(
-        vectorContainsMove(legalMoves, Move(Square(6, 2), Square(7, 2),
+        legalMoves.contains(Move(Square(6, 2), Square(7, 2),
                                             ColoredPiece(BLACK, PAWN))));
 }
 
+TEST(MovementValidatorTest, GetLegalMovesPinsAndChecks) {
+    Position position;
+    MovementValidator validator(&position);
+
+    // Kiwipete: pins, castling both ways, en passant candidates
+    position.loadFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/"
+                     "R3K2R w KQkq - 0 1");
+    EXPECT_EQ(validator.getLegalMoves(WHITE).size(), 48);
+
+    // In check from the bishop on b6: only blocks, captures and king steps
+    position.loadFEN("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/"
+                     "R2Q1RK1 w kq - 0 1");
+    EXPECT_EQ(validator.getLegalMoves(WHITE).size(), 6);
+
+    // Capturing en passant would expose the king along the rank
+    position.loadFEN("8/8/8/KPp4r/8/8/8/4k3 w - c6 0 2");
+    MoveList legalMoves = validator.getLegalMoves(WHITE);
+    EXPECT_FALSE(
+        legalMoves.contains(Move(Square(3, 1), Square(2, 2))));
+
+    // A pinned rook may only slide along the pin
+    position.loadFEN("4r1k1/8/8/8/8/8/4R3/4K3 w - - 0 1");
+    legalMoves = validator.getLegalMoves(WHITE);
+    EXPECT_TRUE(
+        legalMoves.contains(Move(Square(6, 4), Square(0, 4))));
+    EXPECT_FALSE(
+        legalMoves.contains(Move(Square(6, 4), Square(6, 0))));
+
+    // Queenside castling needs b1 empty even though the king never crosses it
+    position.loadFEN("4k3/8/8/8/8/8/8/RN2K3 w Q - 0 1");
+    legalMoves = validator.getLegalMoves(WHITE);
+    EXPECT_FALSE(
+        legalMoves.contains(Move(Square(7, 4), Square(7, 2))));
+}
+
 TEST(MovementValidatorTest, GetLegalMovements) {
     Position position;
     MovementValidator validator(&position);
 
     Square from = Square(6, 4);
-    std::vector<Move> moves = validator.getLegalPawnMovements(from, WHITE);
+    MoveList moves;
+    validator.getLegalPawnMovements(from, WHITE, moves);
 
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(4, 4))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(5, 4))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(4, 4))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(5, 4))));
 
     from = Square(7, 6);
-    moves = validator.getLegalKnightMovements(from, WHITE);
+    moves.clear();
+    validator.getLegalKnightMovements(from, WHITE, moves);
 
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(5, 7))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(5, 5))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(5, 7))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(5, 5))));
 
     position.loadFEN(
         "rnbqkbnr/pppp1ppp/8/4p3/2B1P3/8/PPPP1PPP/RNBQK1NR b KQkq - 1 2");
     from = Square(4, 2);
-    moves = validator.getLegalBishopMovements(from, WHITE);
+    moves.clear();
+    validator.getLegalBishopMovements(from, WHITE, moves);
 
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(7, 5))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(1, 5))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(3, 1))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(7, 5))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(1, 5))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(3, 1))));
 
     position.loadFEN(
         "1nbqkbnr/pppp1ppp/8/2r1p3/2B1P3/8/PPPP1PPP/RNBQK1NR b KQk - 1 2");
     from = Square(3, 2);
-    moves = validator.getLegalRookMovements(from, BLACK);
+    moves.clear();
+    validator.getLegalRookMovements(from, BLACK, moves);
 
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(3, 0))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(2, 2))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(4, 2))));
-    EXPECT_FALSE(vectorContainsMove(moves, Move(from, Square(3, 7))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(3, 0))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(2, 2))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(4, 2))));
+    EXPECT_FALSE(moves.contains(Move(from, Square(3, 7))));
 
     position.loadFEN(
         "rnb1kbnr/pppp1ppp/8/2q1p3/2B1P3/8/PPPP1PPP/RNBQK1NR b KQk - 1 2");
     from = Square(3, 2);
-    moves = validator.getLegalQueenMovements(from, BLACK);
+    moves.clear();
+    validator.getLegalQueenMovements(from, BLACK, moves);
 
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(3, 0))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(2, 2))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(4, 2))));
-    EXPECT_FALSE(vectorContainsMove(moves, Move(from, Square(3, 7))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(1, 4))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(6, 5))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(3, 0))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(2, 2))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(4, 2))));
+    EXPECT_FALSE(moves.contains(Move(from, Square(3, 7))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(1, 4))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(6, 5))));
 
     position.loadFEN(
         "rnb1kb1r/pppp1ppp/5n2/2q1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQk - 3 3");
     from = Square(7, 4);
-    moves = validator.getLegalKingMovements(from, WHITE);
+    moves.clear();
+    validator.getLegalKingMovements(from, WHITE, moves);
 
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(6, 4))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(7, 5))));
-    EXPECT_TRUE(vectorContainsMove(moves, Move(from, Square(7, 6))));
-}
\ No newline at end of file
+    EXPECT_TRUE(moves.contains(Move(from, Square(6, 4))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(7, 5))));
+    EXPECT_TRUE(moves.contains(Move(from, Square(7, 6))));
+}
+
+TEST(MovementValidatorTest, CapturesAndQuietsSplitLegalMoves) {
+    Position position;
+    // Kiwipete plus a pawn on b7 about to promote on a8 or b8
+    position.loadFEN(
+        "r3k2r/pPppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/P1PBBPPP/R3K2R w KQkq - 0 1");
+    MovementValidator validator(&position);
+
+    MoveList all = validator.getLegalMoves(WHITE);
+    MoveList captures = validator.getLegalCaptures(WHITE);
+    MoveList quiets = validator.getLegalQuiets(WHITE);
+    EXPECT_EQ(captures.size() + quiets.size(), all.size());
+
+    for (const Move &move : captures) {
+        EXPECT_TRUE(all.contains(move));
+        EXPECT_TRUE(move.isPromotion() ||
+                    position.getPiece(move.to()) != NO_COLORED_PIECE);
+    }
+    for (const Move &move : quiets) {
+        EXPECT_TRUE(all.contains(move));
+        EXPECT_FALSE(move.isPromotion());
+        EXPECT_EQ(position.getPiece(move.to()), NO_COLORED_PIECE);
+    }
+
+    // Push promotions count as captures, castling as a quiet move
+    EXPECT_TRUE(captures.contains(
+        Move(Square(1, 1), Square(0, 1), ColoredPiece(WHITE, KNIGHT))));
+    EXPECT_TRUE(quiets.contains(Move(Square(7, 4), Square(7, 6))));
+}
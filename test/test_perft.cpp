@@ -0,0 +1,70 @@
+#include "../include/perft.h"
+#include "../include/position.h"
+#include "../include/types.h"
+#include <gtest/gtest.h>
+
+TEST(PerftTest, StartingPosition) {
+    Position position;
+    Perft perft(&position);
+
+    EXPECT_EQ(perft.perft(0), 1);
+    EXPECT_EQ(perft.perft(1), 20);
+    EXPECT_EQ(perft.perft(2), 400);
+    EXPECT_EQ(perft.perft(3), 8902);
+}
+
+TEST(PerftTest, TrickyPositions) {
+    Position position;
+    Perft perft(&position);
+
+    // Castling, pins, en passant and promotions
+    position.loadFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/"
+                     "R3K2R w KQkq - 0 1");
+    EXPECT_EQ(perft.perft(2), 2039);
+
+    position.loadFEN("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    EXPECT_EQ(perft.perft(4), 43238);
+
+    // Promotion clears an en passant square set on the move before
+    position.loadFEN("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+    EXPECT_EQ(perft.perft(3), 62379);
+}
+
+TEST(PerftTest, DivideAndHash) {
+    Position position;
+    position.loadFEN("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/"
+                     "R2Q1RK1 w kq - 0 1");
+    std::string fen = position.getFEN();
+
+    Perft perft(&position);
+    auto divide = perft.divide(3);
+    EXPECT_EQ(divide.size(), 6);
+    uint64_t total = 0;
+    for (const auto &[move, nodes] : divide)
+        total += nodes;
+    EXPECT_EQ(total, 9467);
+
+    position.moveMaker.setMakeMode(MAKE_UNMAKE);
+    EXPECT_EQ(perft.perft(3), 9467);
+    position.moveMaker.setMakeMode(COPY_MAKE);
+
+    perft.setHashSize(1);
+    EXPECT_EQ(perft.perft(3), 9467);
+    EXPECT_EQ(perft.perft(3), 9467);
+    EXPECT_EQ(position.getFEN(), fen);
+}
+
+TEST(PerftTest, ParallelMatchesSerial) {
+    Position position;
+    position.loadFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/"
+                     "R3K2R w KQkq - 0 1");
+    std::string fen = position.getFEN();
+
+    Perft serial(&position);
+    Perft parallel(&position, 4, 4);
+    EXPECT_EQ(parallel.perft(1), 48);
+    EXPECT_EQ(parallel.perft(2), 2039);
+    EXPECT_EQ(parallel.perft(3), 97862);
+    EXPECT_EQ(parallel.divide(2), serial.divide(2));
+    EXPECT_EQ(position.getFEN(), fen);
+}
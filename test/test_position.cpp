@@ -1,6 +1,7 @@
 #include "../include/position.h"
 #include "../include/types.h"
 #include "zobrist.h"
+#include <cstring>
 #include <gtest/gtest.h>
 
 TEST(PositionTest, LoadFenFromStartingPosition) {
@@ -156,24 +157,24 @@ TEST(PositionTest, UndoRedoMove) {
 
 TEST(ZobristHashTest, HashStabilityUnderReversibleMove) {
     Position pos;
-    uint64_t initialHash = pos.zobristHash;
+    uint64_t initialHash = pos.getZobristHash();
 
     Move move(Square(6, 4), Square(5, 4));
 
-    ASSERT_EQ(pos.getPiece(move.from).piece, PAWN);
+    ASSERT_EQ(pos.getPiece(move.from()).piece, PAWN);
 
     pos.moveMaker.makeMove(move);
-    uint64_t afterMoveHash = pos.zobristHash;
+    uint64_t afterMoveHash = pos.getZobristHash();
 
     pos.moveMaker.unmakeMove();
-    uint64_t finalHash = pos.zobristHash;
+    uint64_t finalHash = pos.getZobristHash();
 
     EXPECT_NE(initialHash, afterMoveHash);
     EXPECT_EQ(initialHash, finalHash);
 }
 
 TEST(ZobristHashTest, PerComponentXorReversibility) {
-    Zobrist zobrist = Zobrist();
+    const Zobrist &zobrist = ZOBRIST;
     uint64_t h = 0;
 
     int idx = pieceIndex(ColoredPiece(WHITE, ROOK));
@@ -200,6 +201,21 @@ TEST(ZobristHashTest, PerComponentXorReversibility) {
     }
 }
 
+TEST(ZobristHashTest, CompileTimeKeysAreDistinct) {
+    constexpr uint64_t firstKey = ZOBRIST.pieceKeys[0][0];
+    static_assert(firstKey != 0);
+
+    std::unordered_set<uint64_t> keys;
+    for (const auto &pieceKeys : ZOBRIST.pieceKeys)
+        keys.insert(std::begin(pieceKeys), std::end(pieceKeys));
+    keys.insert(std::begin(ZOBRIST.castlingRightsKey),
+                std::end(ZOBRIST.castlingRightsKey));
+    keys.insert(std::begin(ZOBRIST.enPassantFileKey),
+                std::end(ZOBRIST.enPassantFileKey));
+    keys.insert(ZOBRIST.sideToMoveKey);
+    EXPECT_EQ(keys.size(), 12 * 64 + 16 + 8 + 1);
+}
+
 TEST(ZobristHashTest, IdenticalPositionsHaveSameHash) {
     Position pos1;
     Position pos2;
@@ -207,33 +223,47 @@ TEST(ZobristHashTest, IdenticalPositionsHaveSameHash) {
     ASSERT_EQ(pos1.getFEN(), pos2.getFEN())
         << "Initial positions should be the same";
 
-    EXPECT_EQ(pos1.zobristHash, pos2.zobristHash)
+    EXPECT_EQ(pos1.getZobristHash(), pos2.getZobristHash())
         << "Hashes differ for identical positions";
 
     Move e4(Square(6, 4), Square(4, 4));
     pos1.moveMaker.makeLegalMove(e4);
     pos2.moveMaker.makeLegalMove(e4);
 
-    EXPECT_EQ(pos1.zobristHash, pos2.zobristHash)
+    EXPECT_EQ(pos1.getZobristHash(), pos2.getZobristHash())
         << "Hashes differ for identical positions";
 }
 
 TEST(ZobristHashTest, DifferentPositionsHaveDifferentHash) {
     Position position;
-    std::vector<Move> moves =
+    MoveList moves =
         position.movementValidator.getLegalMoves(position.getTurn());
     ASSERT_FALSE(moves.empty()) << "No legal moves available";
 
     Move move = moves[0];
     position.moveMaker.makeMove(move);
 
-    uint64_t modifiedHash = position.zobristHash;
+    uint64_t modifiedHash = position.getZobristHash();
     Position original;
 
-    EXPECT_NE(modifiedHash, original.zobristHash)
+    EXPECT_NE(modifiedHash, original.getZobristHash())
         << "Modified position should have different hash";
 }
 
+TEST(ZobristHashTest, IncrementalHashMatchesFreshPosition) {
+    Position position;
+    position.loadFEN(
+        "r3k2r/p1pp1pb1/bn2pnp1/2qPN3/1p2P3/2N2Q1p/PPPBBPpP/R3K2R w KQkq - 0 1");
+
+    // Castling, a double step, en passant and a capturing promotion
+    for (const char *uci : {"e1g1", "c7c5", "d5c6", "g2f1q", "a1f1"}) {
+        position.moveMaker.makeLegalMove(position.moveParser.uciToMove(uci));
+        Position fresh;
+        fresh.loadFEN(position.getFEN());
+        EXPECT_EQ(position.getZobristHash(), fresh.getZobristHash()) << uci;
+    }
+}
+
 TEST(PositionTest, PiecesLists) {
     Position position;
 
@@ -285,4 +315,49 @@ TEST(PositionTest, PiecesLists) {
     EXPECT_FALSE(whitePiecesSquares.contains(Square(3, 4)));
     blackPiecesSquares = position.getPiecesSquares(BLACK);
     EXPECT_FALSE(blackPiecesSquares.contains(Square(3, 5)));
-}
\ No newline at end of file
+}
+
+TEST(PositionTest, KingIndex) {
+    // Read from the king bitboards, so they follow moves and takebacks
+    Position position;
+
+    EXPECT_EQ(position.getKingSquare(WHITE), Square(7, 4));
+    EXPECT_EQ(position.getKingSquare(BLACK), Square(0, 4));
+
+    position.loadFEN(
+        "r3k2r/pppq1ppp/2n2n2/3pp3/3PP3/2N2N2/PPPQ1PPP/R3K2R w KQkq - 0 1");
+    position.moveMaker.makeLegalMove(Move(Square(7, 4), Square(7, 6)));
+    EXPECT_EQ(position.getKingSquare(WHITE), Square(7, 6));
+    position.moveMaker.makeLegalMove(Move(Square(0, 4), Square(0, 2)));
+    EXPECT_EQ(position.getKingSquare(BLACK), Square(0, 2));
+
+    position.moveMaker.unmakeMove();
+    position.moveMaker.unmakeMove();
+    EXPECT_EQ(position.getKingSquare(WHITE), Square(7, 4));
+    EXPECT_EQ(position.getKingSquare(BLACK), Square(0, 4));
+
+    position.loadFEN("8/8/8/8/8/8/8/4K3 w - - 0 1");
+    EXPECT_EQ(position.getKingSquare(BLACK), INVALID_SQUARE);
+    EXPECT_EQ(position.getKingIndex(WHITE), 60);
+}
+
+TEST(PositionTest, CopyConstructor) {
+    Position position;
+    position.loadFEN(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    position.moveMaker.makeLegalMove(position.moveParser.uciToMove("a2a4"));
+
+    Position copy(position);
+    EXPECT_EQ(std::memcmp(&copy.getState(), &position.getState(),
+                          sizeof(BoardState)),
+              0);
+    EXPECT_EQ(copy.getFEN(), position.getFEN());
+    EXPECT_EQ(copy.getZobristHash(), position.getZobristHash());
+    EXPECT_EQ(copy.getKingSquare(BLACK), position.getKingSquare(BLACK));
+    EXPECT_EQ(copy.getInputTensor(), position.getInputTensor());
+
+    // The copy moves independently of the original
+    copy.moveMaker.makeLegalMove(copy.moveParser.uciToMove("b4a3"));
+    EXPECT_NE(copy.getFEN(), position.getFEN());
+    EXPECT_EQ(position.getPiece(Square(4, 1)), ColoredPiece(BLACK, PAWN));
+}